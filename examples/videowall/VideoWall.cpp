@@ -35,14 +35,12 @@
 #include <QtAV/VideoRendererTypes.h>
 
 using namespace QtAV;
-const int kSyncInterval = 2000;
 
 VideoWall::VideoWall(QObject *parent) :
     QObject(parent),r(3),c(3),view(0),menu(0)
   , vid("qpainter")
 {
-    clock = new AVClock(this);
-    clock->setClockType(AVClock::ExternalClock);
+    group = new PlayerGroup(this);
     view = new QWidget;
     if (view) {
         qDebug("WA_OpaquePaintEvent=%d", view->testAttribute(Qt::WA_OpaquePaintEvent));
@@ -149,8 +147,7 @@ void VideoWall::show()
             }
             AVPlayer *player = new AVPlayer;
             player->setRenderer(renderer);
-            player->masterClock()->setClockAuto(false);
-            player->masterClock()->setClockType(AVClock::ExternalClock);
+            group->addPlayer(player);
             players.append(player);
             if (view)
                 ((QGridLayout*)view->layout())->addWidget(renderer->widget(), i, j);
@@ -162,21 +159,12 @@ void VideoWall::play(const QString &file)
 {
     if (players.isEmpty())
         return;
-    clock->reset();
-    clock->start();
-    foreach (AVPlayer *player, players) {
-        player->play(file);
-    }
-    timer_id = startTimer(kSyncInterval);
+    group->play(file);
 }
 
 void VideoWall::stop()
 {
-    clock->reset();
-    killTimer(timer_id);
-    foreach (AVPlayer* player, players) {
-        player->stop(); //check playing?
-    }
+    group->stop();
 }
 
 void VideoWall::openLocalFile()
@@ -184,16 +172,7 @@ void VideoWall::openLocalFile()
     QString file = QFileDialog::getOpenFileName(0, tr("Open a video"));
     if (file.isEmpty())
         return;
-    stop();
-    foreach (AVPlayer* player, players) {
-        player->load(file);
-    }
-    clock->reset();
-    clock->start();
-    timer_id = startTimer(kSyncInterval);
-    foreach (AVPlayer* player, players) {
-        player->play();
-    }
+    group->play(file);
 }
 
 void VideoWall::openUrl()
@@ -201,16 +180,7 @@ void VideoWall::openUrl()
     QString url = QInputDialog::getText(0, tr("Open an url"), tr("Url"));
     if (url.isEmpty())
         return;
-    stop();
-    foreach (AVPlayer* player, players) {
-        player->load(url);
-    }
-    clock->reset();
-    clock->start();
-    timer_id = startTimer(kSyncInterval);
-    foreach (AVPlayer* player, players) {
-        player->play();
-    }
+    group->play(url);
 }
 
 void VideoWall::about()
@@ -263,9 +233,7 @@ bool VideoWall::eventFilter(QObject *watched, QEvent *event)
         }
             break;
         case Qt::Key_N: //check playing?
-            foreach (AVPlayer* player, players) {
-                player->playNextFrame();
-            }
+            group->playNextFrame();
             break;
 
         case Qt::Key_O: {
@@ -278,21 +246,13 @@ bool VideoWall::eventFilter(QObject *watched, QEvent *event)
         }
             break;
         case Qt::Key_P:
-            clock->reset();
-            clock->start();
-            foreach (AVPlayer* player, players) {
-                player->play();
-            }
-            timer_id = startTimer(kSyncInterval);
+            group->play();
             break;
         case Qt::Key_S:
             stop();
             break;
         case Qt::Key_Space: //check playing?
-            clock->pause(!clock->isActive());
-            foreach (AVPlayer* player, players) {
-                player->pause(!player->isPaused());
-            }
+            group->togglePause();
             break;
         case Qt::Key_Up:
             foreach (AVPlayer* player, players) {
@@ -324,17 +284,11 @@ bool VideoWall::eventFilter(QObject *watched, QEvent *event)
             break;
         case Qt::Key_Left:
             qDebug("<-");
-            clock->updateExternalClock(clock->value()*1000.0 - 2000.0);
-            /*foreach (AVPlayer* player, players) {
-                player->seekBackward();
-            }*/
+            group->seek(group->masterClock()->value()*1000.0 - 2000.0);
             break;
         case Qt::Key_Right:
             qDebug("->");
-            clock->updateExternalClock(clock->value()*1000.0 + 2000.0);
-            /*foreach (AVPlayer* player, players) {
-                player->seekForward();
-            }*/
+            group->seek(group->masterClock()->value()*1000.0 + 2000.0);
             break;
         case Qt::Key_M:
             foreach (AVPlayer* player, players) {
@@ -382,18 +336,3 @@ bool VideoWall::eventFilter(QObject *watched, QEvent *event)
     }
     return true; //false: for text input
 }
-
-void VideoWall::timerEvent(QTimerEvent *e)
-{
-    if (e->timerId() != timer_id) {
-        qDebug("Not clock id");
-        return;
-    }
-    if (!clock->isActive()) {
-        qDebug("clock not running");
-        return;
-    }
-    foreach (AVPlayer *player, players) {
-        player->masterClock()->updateExternalClock(*clock);
-    }
-}
@@ -23,6 +23,7 @@
 
 #include <QtCore/QList>
 #include <QtAV/AVPlayer.h>
+#include <QtAV/PlayerGroup.h>
 #include <QtAV/WidgetRenderer.h>
 
 class QMenu;
@@ -49,11 +50,9 @@ public slots:
 
 protected:
     virtual bool eventFilter(QObject *, QEvent *);
-    virtual void timerEvent(QTimerEvent *e);
 private:
     int r, c;
-    int timer_id;
-    QtAV::AVClock *clock;
+    QtAV::PlayerGroup *group;
     QList<QtAV::AVPlayer*> players;
     QWidget *view;
     QMenu *menu;
@@ -21,40 +21,106 @@
 
 
 #include <QtAV/AVClock.h>
+#include <QtAV/Logging.h>
+#include <QtCore/QThread>
 
 namespace QtAV {
 
+// larger difference between the measured and the running audio clock is a discontinuity, e.g. seek, underrun
+static const double kAudioResyncThreshold = 0.2;
+// correct 1/10 of the difference for each update, so the clock does not jitter with the device granularity
+static const double kAudioDriftFactor = 0.1;
+
 AVClock::AVClock(AVClock::ClockType c, QObject *parent):
     QObject(parent)
   , auto_clock(true)
-  , clock_type(c)
-  , mSpeed(1.0)
+  , seq(0)
 {
-    pts_ = pts_v = delay_ = 0;
+    state.type = c;
+    state.pts = state.delay = state.pts_v = state.base = 0;
+    state.time = -1;
+    state.speed = 1.0;
+    state.audio_sync = false;
+    timer.start();
 }
 
 AVClock::AVClock(QObject *parent):
     QObject(parent)
   , auto_clock(true)
-  , clock_type(AudioClock)
-  , mSpeed(1.0)
+  , seq(0)
+{
+    state.type = AudioClock;
+    state.pts = state.delay = state.pts_v = state.base = 0;
+    state.time = -1;
+    state.speed = 1.0;
+    state.audio_sync = false;
+    timer.start();
+}
+
+AVClock::State AVClock::snapshot() const
 {
-    pts_ = pts_v = delay_ = 0;
+    forever {
+        // ordered atomic operations are full memory barriers in Qt4 and Qt5
+        const int s0 = seq.fetchAndAddOrdered(0);
+        if (s0 & 1) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const State s = state;
+        if (seq.fetchAndAddOrdered(0) == s0)
+            return s;
+    }
+}
+
+void AVClock::publish(const State &s)
+{
+    seq.fetchAndAddOrdered(1);
+    state = s;
+    seq.fetchAndAddOrdered(1);
+}
+
+qint64 AVClock::now() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    return timer.nsecsElapsed()/1000LL;
+#else
+    return (qint64)timer.elapsed()*1000LL;
+#endif
+}
+
+double AVClock::valueOf(const State &s, qint64 t)
+{
+    if (s.type == AudioClock) {
+        if (!s.audio_sync)
+            return s.pts + s.delay;
+        if (s.time < 0) //paused
+            return s.base;
+        // can not play the data not written yet
+        return qMin(s.base + double(t - s.time) * kThousandth * kThousandth * s.speed, s.pts + s.delay);
+    }
+    if (s.time < 0) //paused
+        return s.base;
+    return s.base + double(t - s.time) * kThousandth * kThousandth * s.speed;
 }
 
 void AVClock::setClockType(ClockType ct)
 {
-    clock_type = ct;
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    State s = state;
+    s.type = ct;
+    publish(s);
 }
 
 AVClock::ClockType AVClock::clockType() const
 {
-    return clock_type;
+    return snapshot().type;
 }
 
 bool AVClock::isActive() const
 {
-    return clock_type == AudioClock || timer.isValid();
+    const State s = snapshot();
+    return s.type == AudioClock || s.time >= 0;
 }
 
 void AVClock::setClockAuto(bool a)
@@ -67,49 +133,171 @@ bool AVClock::isClockAuto() const
     return auto_clock;
 }
 
+double AVClock::pts() const
+{
+    return snapshot().pts;
+}
+
+double AVClock::value() const
+{
+    return valueOf(snapshot(), now());
+}
+
+void AVClock::updateValue(double pts)
+{
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    if (state.type != AudioClock)
+        return;
+    State s = state;
+    s.pts = pts;
+    publish(s);
+}
+
 void AVClock::updateExternalClock(qint64 msecs)
 {
-    if (clock_type != ExternalClock)
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    if (state.type != ExternalClock)
         return;
-    qDebug("External clock change: %f ==> %f", value(), double(msecs) * kThousandth);
-    pts_ = double(msecs) * kThousandth; //can not use msec/1000.
-    timer.restart();
+    const qint64 t = now();
+    QTAV_DEBUG(LogCore, "External clock change: %f ==> %f", valueOf(state, t), double(msecs) * kThousandth);
+    State s = state;
+    s.base = double(msecs) * kThousandth; //can not use msec/1000.
+    s.time = t;
+    publish(s);
 }
 
 void AVClock::updateExternalClock(const AVClock &clock)
 {
-    if (clock_type != ExternalClock)
+    const double v = clock.value();
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    if (state.type != ExternalClock)
         return;
-    qDebug("External clock change: %f ==> %f", value(), clock.value());
-    pts_ = clock.value();
-    timer.restart();
+    const qint64 t = now();
+    QTAV_DEBUG(LogCore, "External clock change: %f ==> %f", valueOf(state, t), v);
+    State s = state;
+    s.base = v;
+    s.time = t;
+    publish(s);
+}
+
+void AVClock::updateVideoPts(double pts)
+{
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    State s = state;
+    s.pts_v = pts;
+    publish(s);
+}
+
+double AVClock::videoPts() const
+{
+    return snapshot().pts_v;
+}
+
+double AVClock::delay() const
+{
+    return snapshot().delay;
+}
+
+void AVClock::updateDelay(double delay)
+{
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    State s = state;
+    s.delay = delay;
+    publish(s);
+}
+
+void AVClock::updateAudioLatency(double latency)
+{
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    if (state.type != AudioClock)
+        return;
+    const qint64 t = now();
+    State s = state;
+    const double measured = s.pts + s.delay - latency;
+    if (!s.audio_sync || s.time < 0) {
+        s.base = measured;
+    } else {
+        const double current = valueOf(s, t);
+        const double diff = measured - current;
+        if (qAbs(diff) > kAudioResyncThreshold)
+            s.base = measured;
+        else
+            s.base = current + diff * kAudioDriftFactor;
+    }
+    s.time = t;
+    s.audio_sync = true;
+    publish(s);
 }
 
 void AVClock::setSpeed(qreal speed)
 {
-    mSpeed = speed;
+    QMutexLocker lock(&write_mutex);
+    Q_UNUSED(lock);
+    State s = state;
+    // rebase so that the value does not jump
+    if (s.time >= 0) {
+        const qint64 t = now();
+        s.base = valueOf(s, t);
+        s.time = t;
+    }
+    s.speed = speed;
+    publish(s);
+}
+
+qreal AVClock::speed() const
+{
+    return snapshot().speed;
 }
 
 void AVClock::start()
 {
     qDebug("AVClock started!!!!!!!!");
-    timer.start();
+    {
+        QMutexLocker lock(&write_mutex);
+        Q_UNUSED(lock);
+        const qint64 t = now();
+        State s = state;
+        if (s.type == ExternalClock)
+            s.base = valueOf(s, t);
+        s.time = t;
+        publish(s);
+    }
     emit started();
 }
 //remember last value because we don't reset  pts_, pts_v, delay_
 void AVClock::pause(bool p)
 {
-    if (clock_type != ExternalClock)
-        return;
+    {
+        QMutexLocker lock(&write_mutex);
+        Q_UNUSED(lock);
+        State s = state;
+        const qint64 t = now();
+        if (s.type != ExternalClock) {
+            // freeze the audible time. restarted by the next updateAudioLatency()
+            if (!s.audio_sync || !p)
+                return;
+            s.base = valueOf(s, t);
+            s.time = -1;
+            publish(s);
+            return;
+        }
+        if (p) {
+            s.base = valueOf(s, t);
+            s.time = -1;
+        } else if (s.time < 0) {
+            s.time = t;
+        }
+        publish(s);
+    }
     if (p) {
-#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
-        timer.invalidate();
-#else
-        timer.stop();
-#endif //QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
         emit paused();
     } else {
-        timer.start();
         emit resumed();
     }
     emit paused(p);
@@ -117,12 +305,15 @@ void AVClock::pause(bool p)
 
 void AVClock::reset()
 {
-    pts_ = pts_v = delay_ = 0;
-#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
-    timer.invalidate();
-#else
-    timer.stop();
-#endif //QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+    {
+        QMutexLocker lock(&write_mutex);
+        Q_UNUSED(lock);
+        State s = state;
+        s.pts = s.pts_v = s.delay = s.base = 0;
+        s.time = -1;
+        s.audio_sync = false;
+        publish(s);
+    }
     emit resetted();
 }
 
@@ -88,9 +88,18 @@ bool AVDecoder::open()
     //HAVE_AVCODEC_MT macro?
     if (d.threads == -1)
         d.threads = qMax(0, QThread::idealThreadCount());
-    if (d.threads > 0)
-        d.codec_ctx->thread_count = d.threads;
-    if (d.threads > 1)
+    int threads = d.threads;
+    // codec threads of all players are limited by a global budget. audio decoders and codecs
+    // without threading do not use the threads, so they are not charged
+    if (threads > 1 && d.codec_ctx->codec_type == AVMEDIA_TYPE_VIDEO
+            && (codec->capabilities & (CODEC_CAP_FRAME_THREADS | CODEC_CAP_SLICE_THREADS))) {
+        d.releaseCodecThreads();
+        d.codec_threads = WorkerPool::instance().acquireCodecThreads(threads);
+        threads = d.codec_threads;
+    }
+    if (threads > 0)
+        d.codec_ctx->thread_count = threads;
+    if (threads > 1)
         d.codec_ctx->thread_type = d.thread_slice ? FF_THREAD_SLICE : FF_THREAD_FRAME;
     d.codec_ctx->thread_safe_callbacks = true;
     switch (d.codec_ctx->codec_id) {
@@ -118,6 +127,7 @@ bool AVDecoder::open()
     // hwa extra init can be here
     if (!d.open()) {
         d.close();
+        d.releaseCodecThreads();
         return false;
     }
     //set dict used by avcodec_open2(). see ffplay
@@ -125,6 +135,7 @@ bool AVDecoder::open()
     int ret = avcodec_open2(d.codec_ctx, codec, d.options.isEmpty() ? NULL : &d.dict);
     if (ret < 0) {
         qWarning("open video codec failed: %s", av_err2str(ret));
+        d.releaseCodecThreads();
         return false;
     }
     d.is_open = true;
@@ -140,6 +151,7 @@ bool AVDecoder::close()
     d.is_open = false;
     // hwa extra finalize can be here
     d.close();
+    d.releaseCodecThreads();
     // TODO: reset config?
     if (!d.codec_ctx) {
         qWarning("FFmpeg codec context not ready");
@@ -24,6 +24,9 @@
 #include <QtAV/AVDecoder.h>
 #include <QtAV/Packet.h>
 #include <QtAV/AVThread.h>
+#include <QtAV/AVClock.h>
+#include <QtAV/Logging.h>
+#include <QtAV/Statistics.h>
 #include <QtCore/QTimer>
 #include <QtCore/QEventLoop>
 
@@ -31,6 +34,15 @@
 
 namespace QtAV {
 
+// trick-play: a key frame later than this is dropped if another one is just forwarded
+static const qint64 kTrickPlayMaxLate = 200; //ms
+// trick-play: seek ahead if reading is late more than this
+static const qint64 kTrickPlaySeekLate = 1000; //ms
+// rewind: interval between 2 seeks. AVDemuxer ignores seeks in 168ms
+static const qint64 kTrickPlayRewindInterval = 200; //ms
+// rewind: max packets to read after seek to find a video key frame
+static const int kTrickPlayMaxReads = 512;
+
 class QueueEmptyCall : public PacketQueue::StateChangeCallback
 {
 public:
@@ -59,6 +71,13 @@ AVDemuxThread::AVDemuxThread(QObject *parent) :
     QThread(parent),paused(false),seeking(false),end(true)
     ,demuxer(0)
     ,audio_thread(0),video_thread(0)
+  , trick_speed(0)
+  , trick_reset(false)
+  , trick_start_time(0)
+  , trick_start_pos(0)
+  , trick_last_key(0)
+  , trick_last_forward(0)
+  , statistics(0)
 {
 }
 
@@ -66,6 +85,13 @@ AVDemuxThread::AVDemuxThread(AVDemuxer *dmx, QObject *parent) :
     QThread(parent),paused(false),seeking(false),end(true)
     ,audio_thread(0),video_thread(0)
   , running_threads(0)
+  , trick_speed(0)
+  , trick_reset(false)
+  , trick_start_time(0)
+  , trick_start_pos(0)
+  , trick_last_key(0)
+  , trick_last_forward(0)
+  , statistics(0)
 {
     setDemuxer(dmx);
 }
@@ -75,6 +101,11 @@ void AVDemuxThread::setDemuxer(AVDemuxer *dmx)
     demuxer = dmx;
 }
 
+void AVDemuxThread::setStatistics(Statistics *s)
+{
+    statistics = s;
+}
+
 void AVDemuxThread::setAVThread(AVThread*& pOld, AVThread *pNew)
 {
     if (pOld == pNew)
@@ -120,11 +151,39 @@ AVThread* AVDemuxThread::audioThread()
     return audio_thread;
 }
 
+void AVDemuxThread::setTrickPlaySpeed(qreal speed)
+{
+    {
+        QMutexLocker lock(&trick_mutex);
+        Q_UNUSED(lock);
+        if (trick_speed == speed)
+            return;
+        QTAV_DEBUG(LogDemux, "trick-play speed: %.2f", speed);
+        trick_speed = speed;
+        trick_reset = true;
+    }
+    trick_cond.wakeAll();
+}
+
+qreal AVDemuxThread::trickPlaySpeed() const
+{
+    QMutexLocker lock(&trick_mutex);
+    Q_UNUSED(lock);
+    return trick_speed;
+}
+
 void AVDemuxThread::seek(qint64 pos)
 {
     qDebug("demux thread start to seek...");
     seeking = true;
     end = false;
+    {
+        // pacing restarts from the new position
+        QMutexLocker lock(&trick_mutex);
+        Q_UNUSED(lock);
+        trick_reset = true;
+    }
+    trick_cond.wakeAll();
     if (audio_thread) {
         audio_thread->setDemuxEnded(false);
         audio_thread->packetQueue()->clear();
@@ -143,6 +202,11 @@ void AVDemuxThread::seek(qint64 pos)
         video_thread->packetQueue()->clear();
         video_thread->packetQueue()->put(Packet());
     }
+    // the frames waiting for presentation are out of date
+    if (audio_thread)
+        audio_thread->interruptWait();
+    if (video_thread)
+        video_thread->interruptWait();
     //if (subtitle_thread) {
     //     subtitle_thread->packetQueue()->clear();
     //    subtitle_thread->packetQueue()->put(Packet());
@@ -192,6 +256,7 @@ void AVDemuxThread::stop()
     }
     pause(false);
     seek_cond.wakeAll();
+    trick_cond.wakeAll();
 }
 
 void AVDemuxThread::pause(bool p)
@@ -202,6 +267,7 @@ void AVDemuxThread::pause(bool p)
     paused = p;
     if (!paused)
         cond.wakeAll();
+    trick_cond.wakeAll();
 }
 
 void AVDemuxThread::notifyEnd()
@@ -261,15 +327,20 @@ void AVDemuxThread::run()
         vqueue->setBlocking(true);
     }
     while (!end) {
-        if (tryPause())
+        if (tryPause()) {
+            // do not catch up the paused time
+            QMutexLocker lock(&trick_mutex);
+            Q_UNUSED(lock);
+            trick_reset = true;
             continue; //the queue is empty and will block
+        }
         QMutexLocker locker(&buffer_mutex);
         Q_UNUSED(locker);
         if (end) {
 #if CORRECT_END
             if ((audio_thread && audio_thread->isRunning())
                     || (video_thread && video_thread->isRunning())) {
-                qDebug("demux read end but avthread still running. waiting for finish...");
+                QTAV_DEBUG_LIMITED(LogDemux, "demux read end but avthread still running. waiting for finish...");
                 cond.wait(&buffer_mutex);
             }
             if (end)
@@ -277,19 +348,37 @@ void AVDemuxThread::run()
                 break;
         }
         if (seeking) {
-            qDebug("Demuxer is seeking... wait for seek end");
+            QTAV_DEBUG_LIMITED(LogDemux, "Demuxer is seeking... wait for seek end");
             if (!seek_cond.wait(&buffer_mutex, 200)) { //will return the same state(i.e. lock)
-                qWarning("seek timed out");
+                QTAV_WARNING(LogDemux, "seek timed out");
+            }
+        }
+        const qreal trick = trickPlaySpeed();
+        if (trick != 0) {
+            bool reset = false;
+            {
+                QMutexLocker lock(&trick_mutex);
+                Q_UNUSED(lock);
+                reset = trick_reset;
+                trick_reset = false;
+            }
+            if (reset)
+                resetTrickPlay(aqueue, vqueue);
+            if (trick < 0) {
+                rewindStep(trick, vqueue);
+                continue;
             }
         }
+        const qint64 read_start = Statistics::timestamp();
         if (!demuxer->readFrame()) {
             continue;
         }
         index = demuxer->stream();
         pkt = *demuxer->packet(); //TODO: how to avoid additional copy?
+        pkt.read_time = Statistics::timestamp();
         //connect to stop is ok too
         if (pkt.isEnd()) {
-            qDebug("read end packet %d A:%d V:%d", index, audio_stream, video_stream);
+            QTAV_DEBUG(LogDemux, "read end packet %d A:%d V:%d", index, audio_stream, video_stream);
             end = true;
             bool all_end = true;
             //avthread can stop. do not clear queue, make sure all data are played
@@ -310,6 +399,17 @@ void AVDemuxThread::run()
             }
             break;
         }
+        if (statistics) {
+            if (index == audio_stream)
+                statistics->audio_pipeline.addLatency(Statistics::Pipeline::Read, pkt.read_time - read_start);
+            else if (index == video_stream)
+                statistics->video_pipeline.addLatency(Statistics::Pipeline::Read, pkt.read_time - read_start);
+        }
+        if (trick > 0) {
+            if (index == video_stream && pkt.hasKeyFrame)
+                forwardKeyFrame(pkt, vqueue);
+            continue;
+        }
         /*1 is empty but another is enough, then do not block to
           ensure the empty one can put packets immediatly.
           But usually it will not happen, why?
@@ -350,6 +450,115 @@ void AVDemuxThread::run()
     qDebug("Demux thread stops running....");
 }
 
+void AVDemuxThread::resetTrickPlay(PacketQueue *aqueue, PacketQueue *vqueue)
+{
+    // drop the normal packets and flush the decoders. the clock is already at the current position
+    if (aqueue) {
+        aqueue->clear();
+        aqueue->put(Packet());
+    }
+    if (vqueue) {
+        vqueue->clear();
+        vqueue->put(Packet());
+    }
+    AVThread *thread = video_thread ? video_thread : audio_thread;
+    trick_start_pos = thread && thread->clock() ? thread->clock()->value() : 0;
+    if (trick_timer.isValid())
+        trick_timer.restart();
+    else
+        trick_timer.start();
+    trick_start_time = 0;
+    trick_last_forward = -kTrickPlayMaxLate;
+    // rewind: the first key frame must not be after the current position
+    trick_last_key = trick_start_pos + 0.001;
+}
+
+void AVDemuxThread::forwardKeyFrame(const Packet &pkt, PacketQueue *vqueue)
+{
+    if (!vqueue)
+        return;
+    const qreal speed = trickPlaySpeed();
+    if (speed <= 0)
+        return;
+    const qint64 target = trick_start_time + qint64((pkt.pts - trick_start_pos)*1000.0/speed);
+    const qint64 now = trick_timer.elapsed();
+    const qint64 late = now - target;
+    if (late > kTrickPlaySeekLate) {
+        // reading every packet is slower than the speed, e.g. all intra or slow io. jump to the expected position
+        const qint64 pos = qint64((trick_start_pos + qreal(now - trick_start_time)*speed/1000.0)*1000.0);
+        QTAV_DEBUG_LIMITED(LogDemux, "trick-play late %lld ms. seek to %lld", late, pos);
+        demuxer->seek(pos);
+        return;
+    }
+    if (late > kTrickPlayMaxLate && now - trick_last_forward < kTrickPlayMaxLate)
+        return;
+    if (late < 0 && !waitTrickPlay(-late))
+        return;
+    if (video_thread && video_thread->clock())
+        video_thread->clock()->updateExternalClock(qint64(pkt.pts*1000.0));
+    // no next packet pushes a delayed (reordered) picture out of the decoder
+    Packet key(pkt);
+    key.drain = true;
+    vqueue->put(key);
+    trick_last_forward = trick_timer.elapsed();
+}
+
+void AVDemuxThread::rewindStep(qreal speed, PacketQueue *vqueue)
+{
+    const qint64 now = trick_timer.elapsed();
+    const qint64 start = demuxer->startTime();
+    // speed < 0
+    qint64 pos = qint64((trick_start_pos + qreal(now - trick_start_time)*speed/1000.0)*1000.0);
+    if (pos <= start) {
+        if (trick_last_key*1000.0 <= qreal(start) + 1.0) {
+            // the first key frame is shown. hold the position and wait for a new speed or seek
+            if (video_thread && video_thread->clock())
+                video_thread->clock()->updateExternalClock(qint64(trick_last_key*1000.0));
+            waitTrickPlay(kTrickPlayRewindInterval);
+            return;
+        }
+        pos = start;
+    }
+    // the demuxer may seek to the key frame after pos, so retry with the later position if not moved back
+    if (!vqueue || !demuxer->seek(pos)) {
+        waitTrickPlay(kTrickPlayRewindInterval/4);
+        return;
+    }
+    for (int i = 0; i < kTrickPlayMaxReads && !end; ++i) {
+        if (!demuxer->readFrame())
+            continue;
+        const Packet &pkt = *demuxer->packet();
+        if (pkt.isEnd())
+            break;
+        if (demuxer->stream() != video_stream || !pkt.hasKeyFrame)
+            continue;
+        if (pkt.pts < trick_last_key - 0.001) {
+            trick_last_key = pkt.pts;
+            if (video_thread && video_thread->clock())
+                video_thread->clock()->updateExternalClock(qint64(pkt.pts*1000.0));
+            Packet key(pkt);
+            key.drain = true;
+            vqueue->put(key);
+        }
+        break;
+    }
+    waitTrickPlay(kTrickPlayRewindInterval);
+}
+
+bool AVDemuxThread::waitTrickPlay(qint64 ms)
+{
+    if (ms <= 0)
+        return true;
+    {
+        QMutexLocker lock(&trick_mutex);
+        Q_UNUSED(lock);
+        if (trick_reset)
+            return false;
+    }
+    // buffer_mutex is locked by run()
+    return !trick_cond.wait(&buffer_mutex, (unsigned long)ms);
+}
+
 bool AVDemuxThread::tryPause()
 {
     if (!paused)
@@ -22,8 +22,10 @@
 #include <QtAV/AVDemuxer.h>
 #include <QtAV/AVError.h>
 #include <QtAV/Packet.h>
+#include <QtAV/Logging.h>
 #include <QtAV/QtAV_Compat.h>
 #include <QtAV/QAVIOContext.h>
+#include <QtAV/Tracer.h>
 #include <QtCore/QThread>
 #include <QtCore/QCoreApplication>
 
@@ -188,6 +190,7 @@ bool AVDemuxer::readFrame()
 {
     QMutexLocker lock(&mutex);
     Q_UNUSED(lock);
+    Tracer::Scope trace("readFrame", "demux");
     AVPacket packet;
 
     mpInterrup->begin(InterruptHandler::Read);
@@ -203,7 +206,7 @@ bool AVDemuxer::readFrame()
                 pkt->data = QByteArray(); //flush
                 pkt->markEnd();
                 setMediaStatus(EndOfMedia);
-                qDebug("End of file. %s %d", __FUNCTION__, __LINE__);
+                QTAV_DEBUG(LogDemux, "End of file. %s %d", __FUNCTION__, __LINE__);
                 emit finished();
                 return true;
             }
@@ -212,13 +215,13 @@ bool AVDemuxer::readFrame()
             return false; //frames after eof are eof frames
         } else if (ret == AVERROR_INVALIDDATA) {
             emit error(AVError(AVError::ReadError, ret));
-            qWarning("AVERROR_INVALIDDATA");
+            QTAV_WARNING_LIMITED(LogDemux, "AVERROR_INVALIDDATA");
         } else if (ret == AVERROR(EAGAIN)) {
             return true;
         } else {
             emit error(AVError(AVError::ReadError, ret));
         }
-        qWarning("[AVDemuxer] error: %s", av_err2str(ret));
+        QTAV_WARNING_LIMITED(LogDemux, "[AVDemuxer] error: %s", av_err2str(ret));
         return false;
     }
     stream_idx = packet.stream_index; //TODO: check index
@@ -247,6 +250,7 @@ bool AVDemuxer::readFrame()
     pkt->pts *= av_q2d(stream->time_base);
     //TODO: pts must >= 0? look at ffplay
     pkt->pts = qMax<qreal>(0, pkt->pts);
+    trace.setPts(pkt->pts);
     if (stream->codec->codec_type == AVMEDIA_TYPE_SUBTITLE
             && (packet.flags & AV_PKT_FLAG_KEY)
             &&  packet.convergence_duration != AV_NOPTS_VALUE)
@@ -257,7 +261,7 @@ bool AVDemuxer::readFrame()
         pkt->duration = 0;
     //qDebug("AVPacket.pts=%f, duration=%f, dts=%lld", pkt->pts, pkt->duration, packet.dts);
     if (pkt->isCorrupt)
-        qDebug("currupt packet. pts: %f", pkt->pts);
+        QTAV_DEBUG_LIMITED(LogDemux, "currupt packet. pts: %f", pkt->pts);
 
     av_free_packet(&packet); //important!
     return true;
@@ -340,7 +344,7 @@ bool AVDemuxer::seek(qint64 pos)
     if (seek_timer.isValid()) {
         //why sometimes seek_timer.elapsed() < 0
         if (!seek_timer.hasExpired(kSeekInterval)) {
-            qDebug("seek too frequent. ignore");
+            QTAV_DEBUG_LIMITED(LogDemux, "seek too frequent. ignore");
             return false;
         }
         seek_timer.restart();
@@ -354,12 +358,12 @@ bool AVDemuxer::seek(qint64 pos)
     //t: unit is s
     qreal t = q;// * (double)format_context->duration; //
     int ret = av_seek_frame(format_context, -1, (int64_t)(t*AV_TIME_BASE), t > pkt->pts ? 0 : AVSEEK_FLAG_BACKWARD);
-    qDebug("[AVDemuxer] seek to %f %f %lld / %lld", q, pkt->pts, (int64_t)(t*AV_TIME_BASE), durationUs());
+    QTAV_DEBUG(LogDemux, "[AVDemuxer] seek to %f %f %lld / %lld", q, pkt->pts, (int64_t)(t*AV_TIME_BASE), durationUs());
 #else
     //TODO: pkt->pts may be 0, compute manually.
 
     bool backward = upos <= (int64_t)(pkt->pts*AV_TIME_BASE);
-    qDebug("[AVDemuxer] seek to %f %f %lld / %lld backward=%d", double(upos)/double(durationUs()), pkt->pts, upos, durationUs(), backward);
+    QTAV_DEBUG(LogDemux, "[AVDemuxer] seek to %f %f %lld / %lld backward=%d", double(upos)/double(durationUs()), pkt->pts, upos, durationUs(), backward);
     //AVSEEK_FLAG_BACKWARD has no effect? because we know the timestamp
     // FIXME: back flag is opposite? otherwise seek is bad and may crash?
     /* If stream_index is (-1), a default
@@ -395,6 +399,30 @@ void AVDemuxer::seek(qreal q)
     seek(qint64(q*(double)duration()));
 }
 
+bool AVDemuxer::seekToKeyFrame(qint64 pos)
+{
+    if (!v_codec_context || !format_context) {
+        qWarning("can not seek to key frame. no video stream");
+        return false;
+    }
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    AVStream *stream = format_context->streams[videoStream()];
+    // pos is relative to the same origin as Packet.pts
+    int64_t ts = av_rescale(qMax<qint64>(0, pos), stream->time_base.den, (int64_t)stream->time_base.num*1000LL);
+    int ret = av_seek_frame(format_context, videoStream(), ts, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        // no key frame before ts. the 1st one
+        ret = av_seek_frame(format_context, videoStream(), ts, 0);
+    }
+    if (ret < 0) {
+        qWarning("[AVDemuxer] seek to key frame error: %s", av_err2str(ret));
+        return false;
+    }
+    eof = false;
+    return true;
+}
+
 /*
  TODO: seek by byte/frame
   We need to know current playing packet but not current demuxed packet which
@@ -45,6 +45,7 @@
 #include <QtAV/WidgetRenderer.h>
 #include <QtAV/VideoThread.h>
 #include <QtAV/AVDemuxThread.h>
+#include <QtAV/ReverseThread.h>
 #include <QtAV/VideoOutputEventFilter.h>
 #include <QtAV/VideoCapture.h>
 #include <QtAV/AudioOutputTypes.h>
@@ -68,10 +69,19 @@ AVPlayer::AVPlayer(QObject *parent) :
   , video_thread(0)
   , video_capture(0)
   , mSpeed(1.0)
+  , trick_speed(0)
+  , trick_clock_type(AVClock::AudioClock)
+  , reverse_thread(0)
+  , reverse_play(false)
+  , reverse_step(false)
+  , reverse_clock_type(AVClock::AudioClock)
+  , free_run(false)
+  , free_run_clock_type(AVClock::AudioClock)
   , ao_enable(true)
   , mBrightness(0)
   , mContrast(0)
   , mSaturation(0)
+  , worker_priority(0)
 {
     formatCtx = 0;
     last_position = 0;
@@ -103,11 +113,18 @@ AVPlayer::AVPlayer(QObject *parent) :
     connect(&demuxer, SIGNAL(mediaStatusChanged(QtAV::MediaStatus)), this, SIGNAL(mediaStatusChanged(QtAV::MediaStatus)));
     demuxer_thread = new AVDemuxThread(this);
     demuxer_thread->setDemuxer(&demuxer);
+    demuxer_thread->setStatistics(&mStatistics);
     //use direct connection otherwise replay may stop immediatly because slot stop() is called after play()
     connect(demuxer_thread, SIGNAL(finished()), this, SLOT(stopFromDemuxerThread()), Qt::DirectConnection);
 
     video_capture = new VideoCapture(this);
 
+    reverse_thread = new ReverseThread(this);
+    reverse_thread->setClock(clock);
+    reverse_thread->setOutputSet(mpVOSet);
+    connect(reverse_thread, SIGNAL(reachedStart()), this, SLOT(reverseReachedStart()));
+    connect(reverse_thread, SIGNAL(stepped(qreal)), this, SLOT(reverseStepped(qreal)));
+
     vcodec_ids
 #if QTAV_HAVE(DXVA)
             //<< VideoDecoderId_DXVA
@@ -319,7 +336,12 @@ void AVPlayer::setSpeed(qreal speed)
         qDebug("set speed %.2f", mSpeed);
         _audio->setSpeed(mSpeed);
     }
-    masterClock()->setSpeed(mSpeed);
+    // applied when trick-play stops
+    if (reverse_play) {
+        masterClock()->setSpeed(-mSpeed);
+        reverse_thread->interruptWait();
+    } else if (trick_speed == 0)
+        masterClock()->setSpeed(mSpeed);
     emit speedChanged(mSpeed);
 }
 
@@ -328,6 +350,173 @@ qreal AVPlayer::speed() const
     return mSpeed;
 }
 
+void AVPlayer::setTrickPlay(qreal speed)
+{
+    if (speed == trick_speed)
+        return;
+    if (!isPlaying() && speed != 0) {
+        qWarning("trick-play requires playing");
+        return;
+    }
+    if ((reverse_play || reverse_step) && speed != 0) {
+        qWarning("trick-play is not available in reverse playback");
+        return;
+    }
+    if (free_run && speed != 0) {
+        qWarning("trick-play is not available in free run");
+        return;
+    }
+    const qint64 pos = position();
+    const bool was_trick = trick_speed != 0;
+    trick_speed = speed;
+    if (speed != 0) {
+        // key frames are paced by the demux thread and it updates the clock. the clock runs at the speed between key frames
+        if (!was_trick)
+            trick_clock_type = clock->clockType();
+        clock->setClockType(AVClock::ExternalClock);
+        if (!isPaused())
+            clock->updateExternalClock(pos);
+        clock->setSpeed(speed);
+        demuxer_thread->setTrickPlaySpeed(speed);
+    } else {
+        demuxer_thread->setTrickPlaySpeed(0);
+        clock->setClockType(trick_clock_type);
+        clock->setSpeed(mSpeed);
+        // the queues contain key frames only and no audio
+        setPosition(pos);
+    }
+    emit trickPlayChanged(trick_speed);
+}
+
+qreal AVPlayer::trickPlay() const
+{
+    return trick_speed;
+}
+
+void AVPlayer::setReversePlayback(bool r)
+{
+    if (r == reverse_play)
+        return;
+    if (r) {
+        if (!reverse_step && !enterReverse())
+            return;
+        reverse_step = false;
+        reverse_play = true;
+        clock->setSpeed(-mSpeed);
+        clock->pause(false);
+        // a step may be in progress
+        reverse_thread->wait();
+        reverse_thread->start();
+    } else {
+        const bool was_paused = !clock->isActive();
+        leaveReverse();
+        pause(was_paused);
+    }
+    emit reversePlaybackChanged(reverse_play);
+}
+
+bool AVPlayer::isReversePlayback() const
+{
+    return reverse_play;
+}
+
+void AVPlayer::setFreeRun(bool r)
+{
+    if (r == free_run)
+        return;
+    if (r) {
+        if (trick_speed != 0)
+            setTrickPlay(0);
+        if (reverse_play)
+            setReversePlayback(false);
+        else if (reverse_step)
+            leaveReverse();
+        // the threads update the clock with the decoded pts instead of waiting for it
+        free_run_clock_type = clock->clockType();
+        clock->setClockType(AVClock::AudioClock);
+    } else {
+        clock->setClockType(free_run_clock_type);
+    }
+    free_run = r;
+    if (audio_thread)
+        audio_thread->setFreeRun(r);
+    if (video_thread)
+        video_thread->setFreeRun(r);
+    emit freeRunChanged(free_run);
+}
+
+bool AVPlayer::isFreeRun() const
+{
+    return free_run;
+}
+
+void AVPlayer::setReverseCacheSize(qint64 bytes)
+{
+    reverse_thread->cache()->setMemoryBudget(bytes);
+}
+
+qint64 AVPlayer::reverseCacheSize() const
+{
+    return reverse_thread->cache()->memoryBudget();
+}
+
+bool AVPlayer::enterReverse()
+{
+    if (!isPlaying() || path.isEmpty() || m_pIODevice) {
+        qWarning("reverse playback requires playing a local file");
+        return false;
+    }
+    if (free_run) {
+        qWarning("reverse playback is not available in free run");
+        return false;
+    }
+    if (trick_speed != 0)
+        setTrickPlay(0);
+    if (!reverse_thread->cache()->isOpen() && !reverse_thread->cache()->open(path))
+        return false;
+    // the frame on screen. the clock may be ahead of it
+    qint64 pos = clock->videoPts() > 0 ? qint64(clock->videoPts()*1000.0) : position();
+    demuxer_thread->pause(true);
+    if (audio_thread)
+        audio_thread->pause(true);
+    if (video_thread)
+        video_thread->pause(true);
+    reverse_clock_type = clock->clockType();
+    clock->setClockType(AVClock::ExternalClock);
+    clock->updateExternalClock(pos);
+    clock->pause(true);
+    reverse_thread->setEQ(mBrightness, mContrast, mSaturation);
+    return true;
+}
+
+void AVPlayer::leaveReverse()
+{
+    reverse_thread->stop();
+    reverse_thread->wait();
+    const qint64 pos = position();
+    clock->setClockType(reverse_clock_type);
+    clock->setSpeed(mSpeed);
+    reverse_play = false;
+    reverse_step = false;
+    // the packet queues are still at the position reverse playback started
+    setPosition(pos);
+}
+
+void AVPlayer::reverseReachedStart()
+{
+    if (reverse_play)
+        pause(true);
+}
+
+void AVPlayer::reverseStepped(qreal pts)
+{
+    if (!reverse_step && !reverse_play)
+        return;
+    clock->updateExternalClock(qint64(pts*1000.0));
+    clock->pause(true);
+    emit positionChanged(qint64(pts*1000.0));
+}
+
 Statistics& AVPlayer::statistics()
 {
     return mStatistics;
@@ -404,6 +593,16 @@ void AVPlayer::setPriority(const QVector<VideoDecoderId> &ids)
     vcodec_ids = ids;
 }
 
+void AVPlayer::setWorkerPriority(int priority)
+{
+    worker_priority = priority;
+}
+
+int AVPlayer::workerPriority() const
+{
+    return worker_priority;
+}
+
 void AVPlayer::setOptionsForFormat(const QHash<QByteArray, QByteArray> &dict)
 {
     demuxer.setOptions(dict);
@@ -512,6 +711,24 @@ void AVPlayer::togglePause()
 
 void AVPlayer::pause(bool p)
 {
+    if (reverse_play) {
+        // the pipeline is paused. reverse_thread follows the clock
+        clock->pause(p);
+        reverse_thread->interruptWait();
+        if (!p) {
+            if (reverse_thread->isStepping())
+                reverse_thread->wait();
+            if (!reverse_thread->isRunning())
+                reverse_thread->start();
+        }
+        emit paused(p);
+        return;
+    }
+    if (reverse_step) {
+        if (p)
+            return;
+        leaveReverse();
+    }
     //pause thread. check pause state?
     demuxer_thread->pause(p);
     if (audio_thread)
@@ -524,6 +741,8 @@ void AVPlayer::pause(bool p)
 
 bool AVPlayer::isPaused() const
 {
+    if (reverse_play)
+        return !clock->isActive();
     return (demuxer_thread && demuxer_thread->isPaused())
             || (audio_thread && audio_thread->isPaused())
             || (video_thread && video_thread->isPaused());
@@ -594,6 +813,9 @@ bool AVPlayer::load(bool reload)
             masterClock()->setClockType(AVClock::AudioClock);
         }
     }
+    // the clock type to restore is saved by setFreeRun()
+    if (free_run)
+        masterClock()->setClockType(AVClock::AudioClock);
 
     // TODO: what about other proctols? some vob duration() == 0
     if ((path.startsWith("file:") || QFile(path).exists()) && duration() > 0) {
@@ -712,6 +934,9 @@ qreal AVPlayer::positionF() const
 
 qint64 AVPlayer::position() const
 {
+    // no audio clock in free run if there is no audio stream
+    if (free_run && clock->videoPts() > 0)
+        return qMax(clock->value(), clock->videoPts())*1000.0;
     return clock->value()*1000.0; //TODO: avoid *1000.0
 }
 
@@ -959,6 +1184,25 @@ void AVPlayer::stop()
         }
     }
     reset_state = true;
+    if (trick_speed != 0) {
+        trick_speed = 0;
+        demuxer_thread->setTrickPlaySpeed(0);
+        clock->setClockType(trick_clock_type);
+        clock->setSpeed(mSpeed);
+        emit trickPlayChanged(0);
+    }
+    if (reverse_play || reverse_step) {
+        const bool was_play = reverse_play;
+        reverse_thread->stop();
+        reverse_thread->wait();
+        clock->setClockType(reverse_clock_type);
+        clock->setSpeed(mSpeed);
+        reverse_play = false;
+        reverse_step = false;
+        if (was_play)
+            emit reversePlaybackChanged(false);
+    }
+    reverse_thread->cache()->close();
 
     last_position = mediaStopPosition() != std::numeric_limits<qint64>::max() ? startPosition() : 0;
     if (!isPlaying()) {
@@ -1052,6 +1296,22 @@ void AVPlayer::playNextFrame()
     demuxer_thread->pause(true);
 }
 
+void AVPlayer::playPreviousFrame()
+{
+    if (!reverse_play && !reverse_step) {
+        if (!enterReverse())
+            return;
+        reverse_step = true;
+    }
+    if (reverse_play) {
+        reverse_thread->stop();
+        reverse_thread->wait();
+    }
+    clock->pause(true);
+    // decoding a GOP may take long. the clock is updated in reverseStepped(). ignored if a step is in progress
+    reverse_thread->step(clock->value());
+}
+
 void AVPlayer::seek(qreal r)
 {
     seek(qint64(r*double(duration())));
@@ -1091,6 +1351,7 @@ void AVPlayer::setBrightness(int val)
     if (video_thread) {
         video_thread->setBrightness(val);
     }
+    reverse_thread->setEQ(mBrightness, mContrast, mSaturation);
 }
 
 int AVPlayer::contrast() const
@@ -1107,6 +1368,7 @@ void AVPlayer::setContrast(int val)
     if (video_thread) {
         video_thread->setContrast(val);
     }
+    reverse_thread->setEQ(mBrightness, mContrast, mSaturation);
 }
 
 int AVPlayer::saturation() const
@@ -1123,6 +1385,7 @@ void AVPlayer::setSaturation(int val)
     if (video_thread) {
         video_thread->setSaturation(val);
     }
+    reverse_thread->setEQ(mBrightness, mContrast, mSaturation);
 }
 
 //TODO: av_guess_frame_rate in latest ffmpeg
@@ -1220,6 +1483,8 @@ bool AVPlayer::setupAudioThread()
         _audio = AudioOutputFactory::create(AudioOutputId_PortAudio);
 #elif QTAV_HAVE(OPENAL)
         _audio = AudioOutputFactory::create(AudioOutputId_OpenAL);
+#else
+        _audio = AudioOutputFactory::create(AudioOutputId_Null);
 #endif
     }
     if (!_audio) {
@@ -1253,6 +1518,7 @@ bool AVPlayer::setupAudioThread()
         audio_thread->setDecoder(audio_dec);
         audio_thread->setStatistics(&mStatistics);
         audio_thread->setOutputSet(mpAOSet);
+        audio_thread->setFreeRun(free_run);
         qDebug("demux thread setAudioThread");
         demuxer_thread->setAudioThread(audio_thread);
         //reconnect if disconnected
@@ -1314,6 +1580,7 @@ bool AVPlayer::setupVideoThread()
         video_thread->setStatistics(&mStatistics);
         video_thread->setVideoCapture(video_capture);
         video_thread->setOutputSet(mpVOSet);
+        video_thread->setFreeRun(free_run);
         demuxer_thread->setVideoThread(video_thread);
 
         QList<Filter*> filters = FilterManager::instance().videoFilters(this);
@@ -118,6 +118,7 @@ void AVThread::stop()
     d.packets.setBlocking(false); //stop blocking take()
     d.packets.clear();
     pause(false);
+    interruptWait();
     QMutexLocker lock(&d.ready_mutex);
     d.ready = false;
     //terminate();
@@ -134,6 +135,9 @@ void AVThread::pause(bool p)
         qDebug("wake up paused thread");
         d.next_pause = false;
         d.cond.wakeAll();
+    } else {
+        // do not present the waiting frame after pause
+        interruptWait();
     }
 }
 
@@ -143,6 +147,16 @@ void AVThread::nextAndPause()
     d.next_pause = true;
     d.paused = true;
     d.cond.wakeAll();
+    interruptWait();
+}
+
+void AVThread::interruptWait()
+{
+    DPTR_D(AVThread);
+    QMutexLocker lock(&d.wait_mutex);
+    Q_UNUSED(lock);
+    d.wait_interrupted = true;
+    d.wait_cond.wakeAll();
 }
 
 void AVThread::lock()
@@ -212,6 +226,18 @@ void AVThread::setDemuxEnded(bool ended)
     d_func().demux_end = ended;
 }
 
+void AVThread::setFreeRun(bool freeRun)
+{
+    d_func().free_run = freeRun;
+    // a thread waiting for a deadline continues with the new mode
+    interruptWait();
+}
+
+bool AVThread::isFreeRun() const
+{
+    return d_func().free_run;
+}
+
 void AVThread::resetState()
 {
     DPTR_D(AVThread);
@@ -252,6 +278,46 @@ bool AVThread::processNextTask()
     return true;
 }
 
+qint64 AVThread::monotonicTime() const
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    return d_func().sched_timer.nsecsElapsed()/1000LL;
+#else
+    return (qint64)d_func().sched_timer.elapsed()*1000LL;
+#endif
+}
+
+bool AVThread::waitUntil(qint64 deadline)
+{
+    DPTR_D(AVThread);
+    forever {
+        if (d.stop)
+            return false;
+        qint64 remain = deadline - monotonicTime();
+        if (remain <= 0)
+            return true;
+        // QWaitCondition has ms resolution. wait until the last ms then sleep the rest
+        if (remain < 2000LL) {
+            usleep((unsigned long)remain);
+            continue;
+        }
+        QMutexLocker lock(&d.wait_mutex);
+        Q_UNUSED(lock);
+        if (!d.wait_interrupted)
+            d.wait_cond.wait(&d.wait_mutex, (unsigned long)(remain/1000LL - 1LL));
+        if (d.wait_interrupted) {
+            d.wait_interrupted = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AVThread::waitFor(qreal seconds)
+{
+    return waitUntil(monotonicTime() + qint64(seconds*1000000.0));
+}
+
 void AVThread::setStatistics(Statistics *statistics)
 {
     DPTR_D(AVThread);
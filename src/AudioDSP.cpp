@@ -0,0 +1,589 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "private/AudioDSP_p.h"
+#include "QtAV/AudioFrame.h"
+#include "QtAV/Logging.h"
+#include "QtAV/QtAV_Compat.h"
+#include <QtCore/QtGlobal>
+#include <QtCore/QVarLengthArray>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QTAV_DSP_SSE2 1
+#include <emmintrin.h>
+#endif
+// AVX functions are compiled with the target attribute, so no global -mavx is required
+#if QTAV_DSP_SSE2 && defined(AV_CPU_FLAG_AVX)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define QTAV_DSP_AVX 1
+#define QTAV_TARGET_AVX __attribute__((target("avx")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1600
+#define QTAV_DSP_AVX 1
+#define QTAV_TARGET_AVX
+#endif
+#endif
+#if QTAV_DSP_AVX
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define QTAV_DSP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace QtAV {
+namespace AudioDSP {
+
+static inline qint16 toS16(float v)
+{
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (qint16)(v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+static void gain_f32_c(float *data, int count, float g)
+{
+    for (int i = 0; i < count; ++i)
+        data[i] *= g;
+}
+
+static void gain_s16_c(qint16 *data, int count, float g)
+{
+    for (int i = 0; i < count; ++i)
+        data[i] = toS16((float)data[i] * g);
+}
+
+static void clip_f32_c(float *data, int count, float minValue, float maxValue)
+{
+    for (int i = 0; i < count; ++i)
+        data[i] = qBound(minValue, data[i], maxValue);
+}
+
+static void s16_to_f32_c(const qint16 *src, float *dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = (float)src[i] * (1.0f/32768.0f);
+}
+
+static void f32_to_s16_c(const float *src, qint16 *dst, int count)
+{
+    for (int i = 0; i < count; ++i)
+        dst[i] = toS16(src[i] * 32768.0f);
+}
+
+static float dot_c(const float *a, const float *b, int count)
+{
+    float s = 0;
+    for (int i = 0; i < count; ++i)
+        s += a[i]*b[i];
+    return s;
+}
+
+static void crossfade_c(const float *a, const float *b, const float *w, float *out, int count)
+{
+    for (int i = 0; i < count; ++i)
+        out[i] = a[i] + (b[i] - a[i])*w[i];
+}
+
+static void mix_stereo_mono_c(const float *in, float *out, int frames, float l, float r)
+{
+    for (int i = 0; i < frames; ++i)
+        out[i] = in[2*i]*l + in[2*i+1]*r;
+}
+
+#if QTAV_DSP_SSE2
+static void gain_f32_sse2(float *data, int count, float g)
+{
+    const __m128 vg = _mm_set1_ps(g);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), vg));
+        _mm_storeu_ps(data + i + 4, _mm_mul_ps(_mm_loadu_ps(data + i + 4), vg));
+    }
+    gain_f32_c(data + i, count - i, g);
+}
+
+// _mm_cvtps_epi32 rounds to nearest and _mm_packs_epi32 saturates
+static void gain_s16_sse2(qint16 *data, int count, float g)
+{
+    const __m128 vg = _mm_set1_ps(g);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, vg))
+                                                             , _mm_cvtps_epi32(_mm_mul_ps(hi, vg))));
+    }
+    gain_s16_c(data + i, count - i, g);
+}
+
+static void clip_f32_sse2(float *data, int count, float minValue, float maxValue)
+{
+    const __m128 vmin = _mm_set1_ps(minValue);
+    const __m128 vmax = _mm_set1_ps(maxValue);
+    int i = 0;
+    for (; i <= count - 4; i += 4)
+        _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), vmin), vmax));
+    clip_f32_c(data + i, count - i, minValue, maxValue);
+}
+
+static void s16_to_f32_sse2(const qint16 *src, float *dst, int count)
+{
+    const __m128 scale = _mm_set1_ps(1.0f/32768.0f);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+    }
+    s16_to_f32_c(src + i, dst + i, count - i);
+}
+
+static void f32_to_s16_sse2(const float *src, qint16 *dst, int count)
+{
+    // clamp before converting, out of range floats are converted to 0x80000000
+    const __m128 vmin = _mm_set1_ps(-32768.0f);
+    const __m128 vmax = _mm_set1_ps(32767.0f);
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m128 lo = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), vmin), vmax);
+        const __m128 hi = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), vmin), vmax);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi)));
+    }
+    f32_to_s16_c(src + i, dst + i, count - i);
+}
+
+static float dot_sse2(const float *a, const float *b, int count)
+{
+    // 2 accumulators to hide the add latency
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    s0 = _mm_add_ps(s0, s1);
+    s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+    s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+    return _mm_cvtss_f32(s0) + dot_c(a + i, b + i, count - i);
+}
+
+static void crossfade_sse2(const float *a, const float *b, const float *w, float *out, int count)
+{
+    int i = 0;
+    for (; i <= count - 4; i += 4) {
+        const __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), _mm_loadu_ps(w + i))));
+    }
+    crossfade_c(a + i, b + i, w + i, out + i, count - i);
+}
+
+static void mix_stereo_mono_sse2(const float *in, float *out, int frames, float l, float r)
+{
+    const __m128 vl = _mm_set1_ps(l);
+    const __m128 vr = _mm_set1_ps(r);
+    int i = 0;
+    for (; i <= frames - 4; i += 4) {
+        const __m128 a = _mm_loadu_ps(in + 2*i); // L0 R0 L1 R1
+        const __m128 b = _mm_loadu_ps(in + 2*i + 4); // L2 R2 L3 R3
+        const __m128 vL = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 vR = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(vL, vl), _mm_mul_ps(vR, vr)));
+    }
+    mix_stereo_mono_c(in + 2*i, out + i, frames - i, l, r);
+}
+#endif //QTAV_DSP_SSE2
+
+#if QTAV_DSP_AVX
+// AVX1 has no 256 bit integer instructions, so only float kernels
+QTAV_TARGET_AVX static void gain_f32_avx(float *data, int count, float g)
+{
+    const __m256 vg = _mm256_set1_ps(g);
+    int i = 0;
+    for (; i <= count - 16; i += 16) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), vg));
+        _mm256_storeu_ps(data + i + 8, _mm256_mul_ps(_mm256_loadu_ps(data + i + 8), vg));
+    }
+    gain_f32_c(data + i, count - i, g);
+}
+
+QTAV_TARGET_AVX static void clip_f32_avx(float *data, int count, float minValue, float maxValue)
+{
+    const __m256 vmin = _mm256_set1_ps(minValue);
+    const __m256 vmax = _mm256_set1_ps(maxValue);
+    int i = 0;
+    for (; i <= count - 8; i += 8)
+        _mm256_storeu_ps(data + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), vmin), vmax));
+    clip_f32_c(data + i, count - i, minValue, maxValue);
+}
+
+QTAV_TARGET_AVX static float dot_avx(const float *a, const float *b, int count)
+{
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i <= count - 16; i += 16) {
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    s0 = _mm256_add_ps(s0, s1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(s0), _mm256_extractf128_ps(s0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s) + dot_c(a + i, b + i, count - i);
+}
+
+QTAV_TARGET_AVX static void crossfade_avx(const float *a, const float *b, const float *w, float *out, int count)
+{
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), va), _mm256_loadu_ps(w + i))));
+    }
+    crossfade_c(a + i, b + i, w + i, out + i, count - i);
+}
+#endif //QTAV_DSP_AVX
+
+#if QTAV_DSP_NEON
+static void gain_f32_neon(float *data, int count, float g)
+{
+    int i = 0;
+    for (; i <= count - 4; i += 4)
+        vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), g));
+    gain_f32_c(data + i, count - i, g);
+}
+
+static void gain_s16_neon(qint16 *data, int count, float g)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const int16x8_t v = vld1q_s16(data + i);
+        float32x4_t lo = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), g);
+        float32x4_t hi = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), g);
+        // vcvtq_s32_f32 truncates and saturates. round half away from zero as the C version
+        lo = vaddq_f32(lo, vbslq_f32(vcltq_f32(lo, vdupq_n_f32(0)), vnegq_f32(half), half));
+        hi = vaddq_f32(hi, vbslq_f32(vcltq_f32(hi, vdupq_n_f32(0)), vnegq_f32(half), half));
+        vst1q_s16(data + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(lo)), vqmovn_s32(vcvtq_s32_f32(hi))));
+    }
+    gain_s16_c(data + i, count - i, g);
+}
+
+static void clip_f32_neon(float *data, int count, float minValue, float maxValue)
+{
+    const float32x4_t vmin = vdupq_n_f32(minValue);
+    const float32x4_t vmax = vdupq_n_f32(maxValue);
+    int i = 0;
+    for (; i <= count - 4; i += 4)
+        vst1q_f32(data + i, vminq_f32(vmaxq_f32(vld1q_f32(data + i), vmin), vmax));
+    clip_f32_c(data + i, count - i, minValue, maxValue);
+}
+
+static void s16_to_f32_neon(const qint16 *src, float *dst, int count)
+{
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        const int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), 1.0f/32768.0f));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), 1.0f/32768.0f));
+    }
+    s16_to_f32_c(src + i, dst + i, count - i);
+}
+
+static void f32_to_s16_neon(const float *src, qint16 *dst, int count)
+{
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        float32x4_t lo = vmulq_n_f32(vld1q_f32(src + i), 32768.0f);
+        float32x4_t hi = vmulq_n_f32(vld1q_f32(src + i + 4), 32768.0f);
+        lo = vaddq_f32(lo, vbslq_f32(vcltq_f32(lo, vdupq_n_f32(0)), vnegq_f32(half), half));
+        hi = vaddq_f32(hi, vbslq_f32(vcltq_f32(hi, vdupq_n_f32(0)), vnegq_f32(half), half));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(lo)), vqmovn_s32(vcvtq_s32_f32(hi))));
+    }
+    f32_to_s16_c(src + i, dst + i, count - i);
+}
+
+static float dot_neon(const float *a, const float *b, int count)
+{
+    float32x4_t s0 = vdupq_n_f32(0);
+    float32x4_t s1 = vdupq_n_f32(0);
+    int i = 0;
+    for (; i <= count - 8; i += 8) {
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    s0 = vaddq_f32(s0, s1);
+    float32x2_t s = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    return vget_lane_f32(vpadd_f32(s, s), 0) + dot_c(a + i, b + i, count - i);
+}
+
+static void crossfade_neon(const float *a, const float *b, const float *w, float *out, int count)
+{
+    int i = 0;
+    for (; i <= count - 4; i += 4) {
+        const float32x4_t va = vld1q_f32(a + i);
+        vst1q_f32(out + i, vmlaq_f32(va, vsubq_f32(vld1q_f32(b + i), va), vld1q_f32(w + i)));
+    }
+    crossfade_c(a + i, b + i, w + i, out + i, count - i);
+}
+
+static void mix_stereo_mono_neon(const float *in, float *out, int frames, float l, float r)
+{
+    int i = 0;
+    for (; i <= frames - 4; i += 4) {
+        const float32x4x2_t v = vld2q_f32(in + 2*i); // deinterleave
+        vst1q_f32(out + i, vaddq_f32(vmulq_n_f32(v.val[0], l), vmulq_n_f32(v.val[1], r)));
+    }
+    mix_stereo_mono_c(in + 2*i, out + i, frames - i, l, r);
+}
+#endif //QTAV_DSP_NEON
+
+struct Kernels {
+    const char *name;
+    void (*gain_f32)(float*, int, float);
+    void (*gain_s16)(qint16*, int, float);
+    void (*clip_f32)(float*, int, float, float);
+    void (*s16_to_f32)(const qint16*, float*, int);
+    void (*f32_to_s16)(const float*, qint16*, int);
+    void (*mix_stereo_mono)(const float*, float*, int, float, float);
+    float (*dot)(const float*, const float*, int);
+    void (*crossfade)(const float*, const float*, const float*, float*, int);
+};
+
+static Kernels cKernels()
+{
+    Kernels k;
+    k.name = "c";
+    k.gain_f32 = gain_f32_c;
+    k.gain_s16 = gain_s16_c;
+    k.clip_f32 = clip_f32_c;
+    k.s16_to_f32 = s16_to_f32_c;
+    k.f32_to_s16 = f32_to_s16_c;
+    k.mix_stereo_mono = mix_stereo_mono_c;
+    k.dot = dot_c;
+    k.crossfade = crossfade_c;
+    return k;
+}
+
+static Kernels detectKernels()
+{
+    Kernels k = cKernels();
+#if QTAV_DSP_SSE2 || QTAV_DSP_AVX
+    const int flags = av_get_cpu_flags();
+#endif
+#if QTAV_DSP_SSE2
+    if (flags & AV_CPU_FLAG_SSE2) {
+        k.name = "sse2";
+        k.gain_f32 = gain_f32_sse2;
+        k.gain_s16 = gain_s16_sse2;
+        k.clip_f32 = clip_f32_sse2;
+        k.s16_to_f32 = s16_to_f32_sse2;
+        k.f32_to_s16 = f32_to_s16_sse2;
+        k.mix_stereo_mono = mix_stereo_mono_sse2;
+        k.dot = dot_sse2;
+        k.crossfade = crossfade_sse2;
+    }
+#endif //QTAV_DSP_SSE2
+#if QTAV_DSP_AVX
+    // the cpu flag is not set if the os does not save ymm registers
+    if (flags & AV_CPU_FLAG_AVX) {
+        k.name = "avx";
+        k.gain_f32 = gain_f32_avx;
+        k.clip_f32 = clip_f32_avx;
+        k.dot = dot_avx;
+        k.crossfade = crossfade_avx;
+    }
+#endif //QTAV_DSP_AVX
+#if QTAV_DSP_NEON
+    // NEON is always available if the compiler generates it
+    k.name = "neon";
+    k.gain_f32 = gain_f32_neon;
+    k.gain_s16 = gain_s16_neon;
+    k.clip_f32 = clip_f32_neon;
+    k.s16_to_f32 = s16_to_f32_neon;
+    k.f32_to_s16 = f32_to_s16_neon;
+    k.mix_stereo_mono = mix_stereo_mono_neon;
+    k.dot = dot_neon;
+    k.crossfade = crossfade_neon;
+#endif //QTAV_DSP_NEON
+    QTAV_DEBUG(LogAudio, "audio dsp: %s", k.name);
+    return k;
+}
+
+static Kernels& kernels()
+{
+    static Kernels k = detectKernels();
+    return k;
+}
+
+const char* simdName()
+{
+    return kernels().name;
+}
+
+void setSIMDEnabled(bool enabled)
+{
+    kernels() = enabled ? detectKernels() : cKernels();
+}
+
+void gain(float *data, int count, float g)
+{
+    if (g == 1.0f || count <= 0)
+        return;
+    kernels().gain_f32(data, count, g);
+}
+
+void gain(qint16 *data, int count, float g)
+{
+    if (g == 1.0f || count <= 0)
+        return;
+    kernels().gain_s16(data, count, g);
+}
+
+void clip(float *data, int count, float minValue, float maxValue)
+{
+    if (count <= 0)
+        return;
+    kernels().clip_f32(data, count, minValue, maxValue);
+}
+
+void s16ToFloat(const qint16 *src, float *dst, int count)
+{
+    if (count <= 0)
+        return;
+    kernels().s16_to_f32(src, dst, count);
+}
+
+void floatToS16(const float *src, qint16 *dst, int count)
+{
+    if (count <= 0)
+        return;
+    kernels().f32_to_s16(src, dst, count);
+}
+
+float dot(const float *a, const float *b, int count)
+{
+    if (count <= 0)
+        return 0;
+    return kernels().dot(a, b, count);
+}
+
+void crossfade(const float *a, const float *b, const float *w, float *out, int count)
+{
+    if (count <= 0)
+        return;
+    kernels().crossfade(a, b, w, out, count);
+}
+
+void mixdown(const float *in, int in_channels, float *out, int out_channels, int frames, const float *matrix)
+{
+    if (in_channels <= 0 || out_channels <= 0 || frames <= 0)
+        return;
+    if (in_channels == 2 && out_channels == 1) {
+        if (matrix)
+            kernels().mix_stereo_mono(in, out, frames, matrix[0], matrix[1]);
+        else
+            kernels().mix_stereo_mono(in, out, frames, 0.5f, 0.5f);
+        return;
+    }
+    const float avg = 1.0f/(float)in_channels;
+    // in and out can be the same buffer if out_channels <= in_channels. a frame is mixed to mixed first
+    QVarLengthArray<float, 8> mixed(out_channels);
+    for (int f = 0; f < frames; ++f) {
+        const float *s = in + f*in_channels;
+        float *d = out + f*out_channels;
+        for (int c = 0; c < out_channels; ++c) {
+            float v = 0;
+            if (matrix) {
+                const float *m = matrix + c*in_channels;
+                for (int i = 0; i < in_channels; ++i)
+                    v += m[i]*s[i];
+            } else {
+                for (int i = 0; i < in_channels; ++i)
+                    v += s[i];
+                v *= avg;
+            }
+            mixed[c] = v;
+        }
+        for (int c = 0; c < out_channels; ++c)
+            d[c] = mixed[c];
+    }
+}
+
+template<typename T>
+static void gain_int(T *data, int count, float g, T minValue, T maxValue)
+{
+    for (int i = 0; i < count; ++i)
+        data[i] = (T)qBound((double)minValue, (double)data[i]*g, (double)maxValue);
+}
+
+bool gain(AudioFrame *frame, qreal g)
+{
+    if (!frame || !frame->isValid())
+        return false;
+    if (g == 1.0)
+        return true;
+    const AudioFormat fmt(frame->format());
+    for (int p = 0; p < frame->planeCount(); ++p) {
+        const int count = frame->bytesPerLine(p)/fmt.bytesPerSample();
+        uchar *data = frame->bits(p);
+        switch (fmt.sampleFormat()) {
+        case AudioFormat::SampleFormat_Float:
+        case AudioFormat::SampleFormat_FloatPlanar:
+            gain((float*)data, count, (float)g);
+            break;
+        case AudioFormat::SampleFormat_Signed16:
+        case AudioFormat::SampleFormat_Signed16Planar:
+            gain((qint16*)data, count, (float)g);
+            break;
+        case AudioFormat::SampleFormat_Unsigned8:
+        case AudioFormat::SampleFormat_Unsigned8Planar: {
+            // 128 is silence
+            quint8 *d = (quint8*)data;
+            for (int i = 0; i < count; ++i)
+                d[i] = (quint8)qBound(0.0, 128.0 + ((double)d[i] - 128.0)*g, 255.0);
+        }
+            break;
+        case AudioFormat::SampleFormat_Signed32:
+        case AudioFormat::SampleFormat_Signed32Planar:
+            gain_int<qint32>((qint32*)data, count, (float)g, (qint32)0x80000000, 0x7fffffff);
+            break;
+        case AudioFormat::SampleFormat_Double:
+        case AudioFormat::SampleFormat_DoublePlanar: {
+            double *d = (double*)data;
+            for (int i = 0; i < count; ++i)
+                d[i] *= g;
+        }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} //namespace AudioDSP
+} //namespace QtAV
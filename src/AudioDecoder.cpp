@@ -24,6 +24,7 @@
 #include <QtAV/QtAV_Compat.h>
 #include <QtAV/AudioResampler.h>
 #include <QtAV/AudioResamplerTypes.h>
+#include <QtAV/Logging.h>
 
 namespace QtAV {
 
@@ -88,11 +89,11 @@ bool AudioDecoder::decode(const QByteArray &encoded)
         return false;
     }
     if (ret < 0) {
-        qWarning("[AudioDecoder] %s", av_err2str(ret));
+        QTAV_WARNING_LIMITED(LogDecoder, "[AudioDecoder] %s", av_err2str(ret));
         return false;
     }
     if (!d.got_frame_ptr) {
-        qWarning("[AudioDecoder] got_frame_ptr=false. decoded: %d, un: %d", ret, d.undecoded_size);
+        QTAV_WARNING_LIMITED(LogDecoder, "[AudioDecoder] got_frame_ptr=false. decoded: %d, un: %d", ret, d.undecoded_size);
         return true;
     }
 #if !QTAV_HAVE(SWRESAMPLE) && !QTAV_HAVE(AVRESAMPLE)
@@ -215,6 +216,23 @@ bool AudioDecoder::decode(const QByteArray &encoded)
     return !d.decoded.isEmpty();
 }
 
+AudioFrame AudioDecoder::frame()
+{
+    DPTR_D(AudioDecoder);
+    if (!d.codec_ctx || d.decoded.isEmpty())
+        return AudioFrame();
+    AudioFormat fmt;
+#if QTAV_HAVE(SWRESAMPLE) || QTAV_HAVE(AVRESAMPLE)
+    fmt = d.resampler->outAudioFormat();
+#else
+    // converted to packed float above
+    fmt.setSampleFormat(AudioFormat::SampleFormat_Float);
+    fmt.setSampleRate(d.codec_ctx->sample_rate);
+    fmt.setChannels(d.codec_ctx->channels);
+#endif //QTAV_HAVE(SWRESAMPLE) || QTAV_HAVE(AVRESAMPLE)
+    return AudioFrame(d.decoded, fmt);
+}
+
 AudioResampler* AudioDecoder::resampler()
 {
     return d_func().resampler;
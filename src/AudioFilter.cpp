@@ -0,0 +1,187 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/AudioFilter.h"
+#include "QtAV/AudioFrame.h"
+#include "private/Filter_p.h"
+#include "private/AudioDSP_p.h"
+
+namespace QtAV {
+
+class AudioFilterPrivate : public FilterPrivate
+{
+public:
+    virtual ~AudioFilterPrivate() {}
+};
+
+AudioFilter::AudioFilter():
+    Filter(*new AudioFilterPrivate())
+{
+}
+
+AudioFilter::AudioFilter(AudioFilterPrivate &d):
+    Filter(d)
+{
+}
+
+AudioFilter::~AudioFilter()
+{
+}
+
+void AudioFilter::process(Statistics *statistics, Frame *frame)
+{
+    // AudioThread always passes an AudioFrame
+    if (!frame)
+        return;
+    process(statistics, static_cast<AudioFrame*>(frame));
+}
+
+
+class VolumeFilterPrivate : public AudioFilterPrivate
+{
+public:
+    VolumeFilterPrivate():
+        volume(1.0)
+      , clip(true)
+    {}
+    qreal volume;
+    bool clip;
+};
+
+VolumeFilter::VolumeFilter():
+    AudioFilter(*new VolumeFilterPrivate())
+{
+}
+
+void VolumeFilter::setVolume(qreal volume)
+{
+    DPTR_D(VolumeFilter);
+    d.volume = volume;
+}
+
+qreal VolumeFilter::volume() const
+{
+    DPTR_D(const VolumeFilter);
+    return d.volume;
+}
+
+void VolumeFilter::setClipEnabled(bool enabled)
+{
+    DPTR_D(VolumeFilter);
+    d.clip = enabled;
+}
+
+bool VolumeFilter::isClipEnabled() const
+{
+    DPTR_D(const VolumeFilter);
+    return d.clip;
+}
+
+void VolumeFilter::process(Statistics *statistics, AudioFrame *frame)
+{
+    Q_UNUSED(statistics);
+    DPTR_D(VolumeFilter);
+    if (d.volume == 1.0 || !frame->isValid())
+        return;
+    AudioDSP::gain(frame, d.volume);
+    if (!d.clip || d.volume < 1.0)
+        return;
+    const AudioFormat fmt(frame->format());
+    if (fmt.sampleFormat() != AudioFormat::SampleFormat_Float
+            && fmt.sampleFormat() != AudioFormat::SampleFormat_FloatPlanar)
+        return;
+    for (int p = 0; p < frame->planeCount(); ++p)
+        AudioDSP::clip((float*)frame->bits(p), frame->bytesPerLine(p)/(int)sizeof(float));
+}
+
+
+class ChannelMixFilterPrivate : public AudioFilterPrivate
+{
+public:
+    ChannelMixFilterPrivate():
+        channels(2)
+    {}
+    int channels;
+    QVector<float> matrix;
+};
+
+ChannelMixFilter::ChannelMixFilter():
+    AudioFilter(*new ChannelMixFilterPrivate())
+{
+}
+
+void ChannelMixFilter::setChannels(int channels)
+{
+    DPTR_D(ChannelMixFilter);
+    d.channels = qMax(channels, 1);
+}
+
+int ChannelMixFilter::channels() const
+{
+    DPTR_D(const ChannelMixFilter);
+    return d.channels;
+}
+
+void ChannelMixFilter::setMatrix(const QVector<float> &matrix)
+{
+    DPTR_D(ChannelMixFilter);
+    d.matrix = matrix;
+}
+
+QVector<float> ChannelMixFilter::matrix() const
+{
+    DPTR_D(const ChannelMixFilter);
+    return d.matrix;
+}
+
+void ChannelMixFilter::process(Statistics *statistics, AudioFrame *frame)
+{
+    Q_UNUSED(statistics);
+    DPTR_D(ChannelMixFilter);
+    if (!frame->isValid())
+        return;
+    AudioFormat fmt(frame->format());
+    const int in_channels = fmt.channels();
+    if (in_channels <= d.channels)
+        return;
+    if (fmt.sampleFormat() != AudioFormat::SampleFormat_Float) {
+        qWarning("ChannelMixFilter: only packed float is supported");
+        return;
+    }
+    const float *matrix = 0;
+    if (!d.matrix.isEmpty()) {
+        if (d.matrix.size() != d.channels*in_channels) {
+            qWarning("ChannelMixFilter: matrix size %d does not match %dx%d", d.matrix.size(), d.channels, in_channels);
+            return;
+        }
+        matrix = d.matrix.constData();
+    }
+    const int samples = frame->samplesPerChannel();
+    QByteArray mixed;
+    mixed.resize(samples*d.channels*(int)sizeof(float));
+    AudioDSP::mixdown((const float*)frame->bits(0), in_channels, (float*)mixed.data(), d.channels, samples, matrix);
+    fmt.setChannels(d.channels);
+    const qreal pts = frame->timestamp();
+    *frame = AudioFrame(mixed, fmt);
+    frame->setTimestamp(pts);
+}
+
+} //namespace QtAV
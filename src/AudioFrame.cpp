@@ -29,8 +29,45 @@ class AudioFramePrivate : public FramePrivate
 public:
     AudioFramePrivate()
         : FramePrivate()
+        , samples_per_channel(0)
+        , timestamp(0)
     {}
+    AudioFramePrivate(const QByteArray& d, const AudioFormat& fmt)
+        : FramePrivate()
+        , format(fmt)
+        , samples_per_channel(0)
+        , timestamp(0)
+    {
+        data = d;
+        if (!format.isValid() || format.bytesPerFrame() <= 0)
+            return;
+        samples_per_channel = data.size()/format.bytesPerFrame();
+        setSamples(0, samples_per_channel);
+    }
     ~AudioFramePrivate() {}
+    // planes point to the samples [offset, offset + count) of data
+    void setSamples(int offset, int count) {
+        samples_per_channel = count;
+        uchar *p = (uchar*)data.constData(); //no detach
+        if (format.isPlanar()) {
+            const int plane_size = data.size()/format.channels();
+            planes.resize(format.channels());
+            line_sizes.resize(format.channels());
+            for (int i = 0; i < planes.size(); ++i) {
+                planes[i] = p + i*plane_size + offset*format.bytesPerSample();
+                line_sizes[i] = count*format.bytesPerSample();
+            }
+        } else {
+            planes.resize(1);
+            line_sizes.resize(1);
+            planes[0] = p + offset*format.bytesPerFrame();
+            line_sizes[0] = count*format.bytesPerFrame();
+        }
+    }
+
+    AudioFormat format;
+    int samples_per_channel;
+    qreal timestamp;
 };
 
 AudioFrame::AudioFrame():
@@ -38,6 +75,11 @@ AudioFrame::AudioFrame():
 {
 }
 
+AudioFrame::AudioFrame(const QByteArray &data, const AudioFormat &format)
+    : Frame(*new AudioFramePrivate(data, format))
+{
+}
+
 /*!
     Constructs a shallow copy of \a other.  Since AudioFrame is
     explicitly shared, these two instances will reflect the same frame.
@@ -63,4 +105,71 @@ AudioFrame::~AudioFrame()
 {
 }
 
+bool AudioFrame::isValid() const
+{
+    Q_D(const AudioFrame);
+    return d->samples_per_channel > 0 && d->format.isValid();
+}
+
+AudioFormat AudioFrame::format() const
+{
+    return d_func()->format;
+}
+
+int AudioFrame::samplesPerChannel() const
+{
+    return d_func()->samples_per_channel;
+}
+
+qreal AudioFrame::timestamp() const
+{
+    return d_func()->timestamp;
+}
+
+void AudioFrame::setTimestamp(qreal ts)
+{
+    Q_D(AudioFrame);
+    d->timestamp = ts;
+}
+
+qreal AudioFrame::duration() const
+{
+    Q_D(const AudioFrame);
+    if (d->format.sampleRate() <= 0)
+        return 0;
+    return qreal(d->samples_per_channel)/qreal(d->format.sampleRate());
+}
+
+AudioFrame AudioFrame::mid(int offset, int count) const
+{
+    Q_D(const AudioFrame);
+    offset = qBound(0, offset, d->samples_per_channel);
+    count = qBound(0, count, d->samples_per_channel - offset);
+    AudioFrame f;
+    // planes of this frame may be a part of data already
+    const int base = d->planes.isEmpty() || d->data.isEmpty() ? 0
+            : (d->format.isPlanar() ? (d->planes[0] - (const uchar*)d->data.constData())/qMax(d->format.bytesPerSample(), 1)
+                                    : (d->planes[0] - (const uchar*)d->data.constData())/qMax(d->format.bytesPerFrame(), 1));
+    AudioFramePrivate *fd = f.d_func();
+    fd->data = d->data; //shared
+    fd->format = d->format;
+    fd->metadata = d->metadata;
+    fd->setSamples(base + offset, count);
+    if (d->format.sampleRate() > 0)
+        fd->timestamp = d->timestamp + qreal(offset)/qreal(d->format.sampleRate());
+    return f;
+}
+
+AudioFrame AudioFrame::clone() const
+{
+    Q_D(const AudioFrame);
+    QByteArray buf;
+    for (int i = 0; i < d->planes.size(); ++i)
+        buf.append((const char*)d->planes[i], d->line_sizes[i]);
+    AudioFrame f(buf, d->format);
+    f.setTimestamp(d->timestamp);
+    f.d_func()->metadata = d->metadata;
+    return f;
+}
+
 } //namespace QtAV
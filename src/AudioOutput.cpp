@@ -21,8 +21,22 @@
 
 #include <QtAV/AudioOutput.h>
 #include <private/AudioOutput_p.h>
+#include <QtAV/AudioFrame.h>
+#include <QtAV/Logging.h>
 
 namespace QtAV {
+
+template<typename T>
+static void interleave(const AudioFrame& frame, int channels, int samples, T *dst)
+{
+    for (int c = 0; c < channels; ++c) {
+        const T *src = (const T*)frame.bits(c);
+        T *out = dst + c;
+        for (int i = 0; i < samples; ++i, out += channels)
+            *out = src[i];
+    }
+}
+
 AudioOutput::AudioOutput()
     :AVOutput(*new AudioOutputPrivate())
 {
@@ -51,6 +65,43 @@ bool AudioOutput::receiveData(const QByteArray &data)
     return write();
 }
 
+bool AudioOutput::receiveData(const AudioFrame &frame)
+{
+    DPTR_D(AudioOutput);
+    if (d.paused || !frame.isValid())
+        return false;
+    if (frame.planeCount() == 1) {
+        d.data = QByteArray::fromRawData((const char*)frame.bits(0), frame.bytesPerLine(0));
+    } else {
+        // 1 plane per channel. devices take interleaved samples
+        const int channels = frame.planeCount();
+        const int samples = frame.samplesPerChannel();
+        const int bps = frame.format().bytesPerSample();
+        d.packed.resize(channels*samples*bps);
+        switch (bps) {
+        case 1:
+            interleave(frame, channels, samples, (quint8*)d.packed.data());
+            break;
+        case 2:
+            interleave(frame, channels, samples, (quint16*)d.packed.data());
+            break;
+        case 4:
+            interleave(frame, channels, samples, (quint32*)d.packed.data());
+            break;
+        case 8:
+            interleave(frame, channels, samples, (quint64*)d.packed.data());
+            break;
+        default:
+            QTAV_WARNING_LIMITED(LogOutput, "AudioOutput: planar audio with %d bytes per sample is not supported", bps);
+            return false;
+        }
+        d.data = QByteArray::fromRawData(d.packed.constData(), d.packed.size());
+    }
+    const bool ok = write();
+    d.data = QByteArray();
+    return ok;
+}
+
 int AudioOutput::maxChannels() const
 {
     return d_func().max_channels;
@@ -128,4 +179,18 @@ qreal AudioOutput::speed() const
     return d_func().speed;
 }
 
+qreal AudioOutput::latency() const
+{
+    return 0;
+}
+
+bool AudioOutput::isRealtime() const
+{
+    return true;
+}
+
+void AudioOutput::clear()
+{
+}
+
 } //namespace QtAV
@@ -0,0 +1,224 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include <QtAV/AudioOutputNull.h>
+#include <private/AudioOutput_p.h>
+#include "prepost.h"
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+#include <QtCore/QElapsedTimer>
+#else
+#include <QtCore/QTime>
+typedef QTime QElapsedTimer;
+#endif
+
+namespace QtAV {
+
+extern AudioOutputId AudioOutputId_Null;
+FACTORY_REGISTER_ID_AUTO(AudioOutput, Null, "Null")
+
+void RegisterAudioOutputNull_Man()
+{
+    FACTORY_REGISTER_ID_MAN(AudioOutput, Null, "Null")
+}
+
+class AudioOutputNullPrivate : public AudioOutputPrivate
+{
+public:
+    AudioOutputNullPrivate()
+        : AudioOutputPrivate()
+        , factor(1.0)
+        , buffer_duration(0.1)
+        , written(0)
+        , base_frames(0)
+        , base_time(0)
+        , underruns(0)
+    {
+        max_channels = 8;
+    }
+    qint64 now() const {
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+        return timer.nsecsElapsed()/1000LL;
+#else
+        return (qint64)timer.elapsed()*1000LL;
+#endif
+    }
+    // samples rate of the emulated device. 0: unlimited
+    qreal rate() const {
+        if (factor <= 0)
+            return 0;
+        return qreal(format.sampleRate())*factor;
+    }
+    // frames played at t(us). a device does not play the data not written
+    qint64 played(qint64 t) const {
+        const qreal r = rate();
+        if (r <= 0)
+            return written;
+        return qMin(written, base_frames + qint64(qreal(t - base_time)*r/1000000.0));
+    }
+
+    qreal factor;
+    qreal buffer_duration;
+    qint64 written;
+    // played frames at base_time
+    qint64 base_frames;
+    qint64 base_time;
+    int underruns;
+    QElapsedTimer timer;
+};
+
+AudioOutputNull::AudioOutputNull()
+    :AudioOutput(*new AudioOutputNullPrivate())
+{
+}
+
+AudioOutputNull::~AudioOutputNull()
+{
+    close();
+}
+
+bool AudioOutputNull::open()
+{
+    DPTR_D(AudioOutputNull);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.written = d.base_frames = 0;
+    d.underruns = 0;
+    d.timer.start();
+    d.base_time = d.now();
+    d.available = true;
+    return true;
+}
+
+bool AudioOutputNull::close()
+{
+    DPTR_D(AudioOutputNull);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.available = false;
+    d.cond.wakeAll();
+    return true;
+}
+
+void AudioOutputNull::setRealtimeFactor(qreal factor)
+{
+    DPTR_D(AudioOutputNull);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    // rebase so that the played position does not jump
+    const qint64 t = d.now();
+    d.base_frames = d.played(t);
+    d.base_time = t;
+    d.factor = factor;
+}
+
+qreal AudioOutputNull::realtimeFactor() const
+{
+    return d_func().factor;
+}
+
+void AudioOutputNull::setBufferDuration(qreal seconds)
+{
+    DPTR_D(AudioOutputNull);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.buffer_duration = qMax<qreal>(seconds, 0);
+}
+
+qreal AudioOutputNull::bufferDuration() const
+{
+    return d_func().buffer_duration;
+}
+
+qint64 AudioOutputNull::playedSamples() const
+{
+    DPTR_D(const AudioOutputNull);
+    return d.played(d.now());
+}
+
+int AudioOutputNull::underruns() const
+{
+    return d_func().underruns;
+}
+
+qreal AudioOutputNull::latency() const
+{
+    DPTR_D(const AudioOutputNull);
+    if (!d.available || d.format.sampleRate() <= 0)
+        return 0;
+    return qreal(d.written - d.played(d.now()))/qreal(d.format.sampleRate());
+}
+
+bool AudioOutputNull::isRealtime() const
+{
+    return d_func().factor > 0;
+}
+
+void AudioOutputNull::clear()
+{
+    DPTR_D(AudioOutputNull);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    // not an underrun in the next write()
+    d.written = d.base_frames = 0;
+    d.base_time = d.now();
+    d.cond.wakeAll();
+}
+
+/*
+ * account the samples and block while the emulated buffer is full, i.e. the audio thread is paced
+ * by the monotonic clock. no accumulative error because the position is computed from the base time
+ */
+bool AudioOutputNull::write()
+{
+    DPTR_D(AudioOutputNull);
+    if (d.data.isEmpty())
+        return false;
+    const int frame_bytes = audioFormat().bytesPerFrame();
+    if (frame_bytes <= 0)
+        return false;
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (!d.available)
+        return false;
+    qint64 t = d.now();
+    if (d.played(t) >= d.written) {
+        // starved. the device restarts from now
+        if (d.written > 0 && d.rate() > 0)
+            ++d.underruns;
+        d.base_frames = d.written;
+        d.base_time = t;
+    }
+    d.written += d.data.size()/frame_bytes;
+    const qint64 buffer_frames = qint64(d.buffer_duration*qreal(audioFormat().sampleRate()));
+    forever {
+        const qreal r = d.rate();
+        if (r <= 0 || !d.available)
+            break;
+        const qint64 excess = d.written - d.played(t) - buffer_frames;
+        if (excess <= 0)
+            break;
+        d.cond.wait(&d.mutex, (ulong)qMax<qint64>(qint64(qreal(excess)*1000.0/r), 1LL));
+        t = d.now();
+    }
+    return true;
+}
+
+} //namespace QtAV
@@ -19,9 +19,10 @@
 
 #include "QtAV/AudioOutputOpenAL.h"
 #include "private/AudioOutput_p.h"
+#include "QtAV/Logging.h"
 #include "prepost.h"
+#include <QtCore/QQueue>
 #include <QtCore/QVector>
-#include <QtCore/QElapsedTimer>
 
 #if defined(HEADER_OPENAL_PREFIX)
 #include <OpenAL/al.h>
@@ -117,8 +118,8 @@ static ALenum audioFormatToAL(const AudioFormat& fmt)
         return false; \
     }}
 
-const int kBufferSize = 4096*2;
-const int kBufferCount = 3;
+const int kBufferSize = 4096;
+const int kBufferCount = 8;
 
 class  AudioOutputOpenALPrivate : public AudioOutputPrivate
 {
@@ -126,23 +127,67 @@ public:
     AudioOutputOpenALPrivate()
         : AudioOutputPrivate()
         , format(AL_FORMAT_STEREO16)
+        , source(0)
         , state(0)
-        , last_duration(0)
+        , buffer_count(kBufferCount)
+        , buffer_size(kBufferSize)
+        , underruns(0)
     {
     }
     ~AudioOutputOpenALPrivate() {
     }
+    // unqueue the processed buffers. return false if AL error
+    bool reclaimBuffers();
+    // ms to play the first queued buffer
+    int firstBufferRemain() const;
 
     ALenum format;
-    ALuint buffer[kBufferCount];
+    QVector<ALuint> buffers;
+    // generated but not queued
+    QVector<ALuint> free_buffers;
     ALuint source;
     ALint state;
-    QElapsedTimer time;
-    qint64 last_duration;
+    int buffer_count, buffer_size;
+    int underruns;
+    // bytes of each buffer in the source queue. the same order as the queue
+    QQueue<int> queued;
     QMutex mutex;
     QWaitCondition cond;
 };
 
+bool AudioOutputOpenALPrivate::reclaimBuffers()
+{
+    ALint processed = 0;
+    alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buf;
+        //unqueues a set of buffers attached to a source
+        alSourceUnqueueBuffers(source, 1, &buf);
+        ALenum err = alGetError();
+        if (err != AL_NO_ERROR) {
+            qWarning("AudioOutputOpenAL Failed to unqueue buffer: %s", alGetString(err));
+            return false;
+        }
+        if (!queued.isEmpty())
+            queued.dequeue();
+        free_buffers.append(buf);
+    }
+    return true;
+}
+
+int AudioOutputOpenALPrivate::firstBufferRemain() const
+{
+    if (queued.isEmpty())
+        return 0;
+    const AudioFormat &af = AudioOutputPrivate::format; // format is the AL format
+    ALint offset = 0; // relative to the first queued buffer after reclaimBuffers()
+    alGetSourcei(source, AL_SAMPLE_OFFSET, &offset);
+    const qint64 samples = qint64(queued.head()/qMax(af.bytesPerFrame(), 1)) - qint64(offset);
+    if (samples <= 0 || af.sampleRate() <= 0)
+        return 0;
+    return int(samples*1000LL/qint64(af.sampleRate()));
+}
+
 AudioOutputOpenAL::AudioOutputOpenAL()
     :AudioOutput(*new AudioOutputOpenALPrivate())
 {
@@ -200,7 +245,8 @@ bool AudioOutputOpenAL::open()
     //init params. move to another func?
     d.format = audioFormatToAL(audioFormat());
 
-    alGenBuffers(kBufferCount, d.buffer);
+    d.buffers.resize(qMax(d.buffer_count, 2));
+    alGenBuffers(d.buffers.size(), d.buffers.data());
     err = alGetError();
     if (err != AL_NO_ERROR) {
         qWarning("Failed to generate OpenAL buffers: %s", alGetString(err));
@@ -213,7 +259,8 @@ bool AudioOutputOpenAL::open()
     err = alGetError();
     if (err != AL_NO_ERROR) {
         qWarning("Failed to generate OpenAL source: %s", alGetString(err));
-        alDeleteBuffers(kBufferCount, d.buffer);
+        alDeleteBuffers(d.buffers.size(), d.buffers.data());
+        d.buffers.clear();
         alcMakeContextCurrent(NULL);
         alcDestroyContext(ctx);
         alcCloseDevice(dev);
@@ -225,7 +272,10 @@ bool AudioOutputOpenAL::open()
     alSource3f(d.source, AL_POSITION, 0.0, 0.0, 0.0);
     alSource3f(d.source, AL_VELOCITY, 0.0, 0.0, 0.0);
     alListener3f(AL_POSITION, 0.0, 0.0, 0.0);
-    qDebug("AudioOutputOpenAL open ok...");
+    qDebug("AudioOutputOpenAL open ok. buffers: %d x %d bytes", d.buffers.size(), d.buffer_size);
+    d.free_buffers = d.buffers;
+    d.queued.clear();
+    d.underruns = 0;
     d.state = 0;
     d.available = true;
     return true;
@@ -238,11 +288,14 @@ bool AudioOutputOpenAL::close()
     DPTR_D(AudioOutputOpenAL);
     d.state = 0;
     d.available = false;
+    d.queued.clear();
     do {
         alGetSourcei(d.source, AL_SOURCE_STATE, &d.state);
     } while (alGetError() == AL_NO_ERROR && d.state == AL_PLAYING);
     alDeleteSources(1, &d.source);
-    alDeleteBuffers(kBufferCount, d.buffer);
+    alDeleteBuffers(d.buffers.size(), d.buffers.data());
+    d.buffers.clear();
+    d.free_buffers.clear();
 
     ALCcontext *ctx = alcGetCurrentContext();
     ALCdevice *dev = alcGetContextsDevice(ctx);
@@ -274,7 +327,94 @@ QString AudioOutputOpenAL::name() const
     return name;
 }
 
-// http://kcat.strangesoft.net/openal-tutorial.html
+qreal AudioOutputOpenAL::latency() const
+{
+    DPTR_D(const AudioOutputOpenAL);
+    if (!d.available || d.state == 0 || d.queued.isEmpty())
+        return 0;
+    const int byte_rate = audioFormat().bytesPerSecond();
+    if (byte_rate <= 0)
+        return 0;
+    ALint state = 0, processed = 0, offset = 0;
+    alGetSourcei(d.source, AL_SOURCE_STATE, &state);
+    alGetSourcei(d.source, AL_BUFFERS_PROCESSED, &processed);
+    qint64 bytes = 0;
+    if (state == AL_PLAYING) {
+        // AL_SAMPLE_OFFSET is relative to the beginning of all queued buffers, including the processed
+        alGetSourcei(d.source, AL_SAMPLE_OFFSET, &offset);
+        for (int i = 0; i < d.queued.size(); ++i)
+            bytes += d.queued.at(i);
+        bytes -= (qint64)offset * (qint64)audioFormat().bytesPerFrame();
+    } else {
+        // stopped because of underrun or not started. the processed buffers will not be played
+        for (int i = processed; i < d.queued.size(); ++i)
+            bytes += d.queued.at(i);
+    }
+    if (bytes <= 0)
+        return 0;
+    return (qreal)bytes/(qreal)byte_rate;
+}
+
+void AudioOutputOpenAL::clear()
+{
+    DPTR_D(AudioOutputOpenAL);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (!d.available)
+        return;
+    // all buffers are processed after stop. rewind to AL_INITIAL, so the next play is not counted as an underrun
+    alSourceStop(d.source);
+    alSourceRewind(d.source);
+    ALint processed = 0;
+    alGetSourcei(d.source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buf;
+        alSourceUnqueueBuffers(d.source, 1, &buf);
+    }
+    ALenum err = alGetError();
+    if (err != AL_NO_ERROR)
+        qWarning("AudioOutputOpenAL Failed to clear the source: %s", alGetString(err));
+    d.free_buffers = d.buffers;
+    d.queued.clear();
+    alGetSourcei(d.source, AL_SOURCE_STATE, &d.state);
+    d.cond.wakeAll();
+}
+
+void AudioOutputOpenAL::setBufferCount(int count)
+{
+    d_func().buffer_count = count;
+}
+
+int AudioOutputOpenAL::bufferCount() const
+{
+    return d_func().buffer_count;
+}
+
+void AudioOutputOpenAL::setBufferSize(int bytes)
+{
+    d_func().buffer_size = bytes;
+}
+
+int AudioOutputOpenAL::bufferSize() const
+{
+    return d_func().buffer_size;
+}
+
+int AudioOutputOpenAL::underruns() const
+{
+    return d_func().underruns;
+}
+
+int AudioOutputOpenAL::queuedBuffers() const
+{
+    return d_func().queued.size();
+}
+
+/*
+ * http://kcat.strangesoft.net/openal-tutorial.html
+ * Refill the processed buffers. If all buffers are queued, wait until the first queued buffer is played.
+ * All data is queued before return.
+ */
 bool AudioOutputOpenAL::write()
 {
     DPTR_D(AudioOutputOpenAL);
@@ -283,60 +423,48 @@ bool AudioOutputOpenAL::write()
     QMutexLocker lock(&d.mutex);
     Q_UNUSED(lock);
     if (d.state == 0) {
-        //// Initial all buffers
         alSourcef(d.source, AL_GAIN, d.vol);
-        for (int i = 0; i < kBufferCount; ++i) {
-            ALERROR_RETURN_F(alBufferData(d.buffer[i], d.format, d.data, d.data.size(), audioFormat().sampleRate()));
-            alSourceQueueBuffers(d.source, 1, &d.buffer[i]);
-        }
-        //alSourceQueueBuffers(d.source, 3, d.buffer);
         alGetSourcei(d.source, AL_SOURCE_STATE, &d.state); //update d.state
-        alSourcePlay(d.source);
-        d.last_duration = audioFormat().durationForBytes(d.data.size())/1000LL*kBufferCount;
-        d.time.start();
-        return true;
-    }
-    qint64 dt = d.last_duration - d.time.elapsed();
-    //qDebug("duration: %lld, dt: %lld", d.last_duration, dt);
-    d.last_duration = audioFormat().durationForBytes(d.data.size())/1000LL;
-    // TODO: how to control the error?
-    if (dt > 0LL)
-        d.cond.wait(&d.mutex, (ulong)dt);
-
-    ALint processed = 0;
-    alGetSourcei(d.source, AL_BUFFERS_PROCESSED, &processed);
-    if (processed <= 0) {
-        alGetSourcei(d.source, AL_SOURCE_STATE, &d.state);
-        if (d.state != AL_PLAYING) {
-            alSourcePlay(d.source);
-        }
-        //return false;
     }
     const char* b = d.data.constData();
     int remain = d.data.size();
-    while (processed--) {
-        if (remain <= 0)
-            break;
-        ALuint buf;
-        //unqueues a set of buffers attached to a source
-        alSourceUnqueueBuffers(d.source, 1, &buf);
-        alBufferData(buf, d.format, b, qMin(remain, kBufferSize), audioFormat().sampleRate());
+    // keep buffers aligned to frames
+    const int frame_bytes = qMax(audioFormat().bytesPerFrame(), 1);
+    const int buffer_size = qMax(d.buffer_size/frame_bytes, 1)*frame_bytes;
+    while (remain > 0) {
+        if (!d.available)
+            return false;
+        if (!d.reclaimBuffers())
+            return false;
+        if (d.free_buffers.isEmpty()) {
+            alGetSourcei(d.source, AL_SOURCE_STATE, &d.state);
+            if (d.state != AL_PLAYING)
+                alSourcePlay(d.source);
+            // no event from OpenAL. wait for the first buffer to be processed
+            d.cond.wait(&d.mutex, (ulong)qMax(d.firstBufferRemain(), 1));
+            continue;
+        }
+        const ALuint buf = d.free_buffers.takeLast();
+        const int size = qMin(remain, buffer_size);
+        alBufferData(buf, d.format, b, size, audioFormat().sampleRate());
         alSourceQueueBuffers(d.source, 1, &buf);
-        b += kBufferSize;
-        remain -= kBufferSize;
-//        qDebug("remain: %d", remain);
         ALenum err = alGetError();
         if (err != AL_NO_ERROR) { //return ?
-            qWarning("AudioOutputOpenAL Error: %s ---remain=%d", alGetString(err), remain);
+            QTAV_WARNING_LIMITED(LogOutput, "AudioOutputOpenAL Error: %s ---remain=%d", alGetString(err), remain);
+            d.free_buffers.append(buf);
             return false;
         }
+        d.queued.enqueue(size);
+        b += size;
+        remain -= size;
     }
-    d.time.restart();
     alGetSourcei(d.source, AL_SOURCE_STATE, &d.state);
     if (d.state != AL_PLAYING) {
+        // stopped after all queued buffers are played
+        if (d.state == AL_STOPPED)
+            ++d.underruns;
         //qDebug("AudioOutputOpenAL: !AL_PLAYING alSourcePlay");
         alSourcePlay(d.source);
-        d.time.restart();
     }
     return true;
 }
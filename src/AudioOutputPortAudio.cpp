@@ -24,7 +24,9 @@
 #include <private/AudioOutput_p.h>
 #include "prepost.h"
 #include <portaudio.h>
+#include <QtCore/QAtomicInt>
 #include <QtCore/QString>
+#include <QtCore/QThread>
 
 namespace QtAV {
 
@@ -36,6 +38,70 @@ void RegisterAudioOutputPortAudio_Man()
     FACTORY_REGISTER_ID_MAN(AudioOutput, PortAudio, "PortAudio")
 }
 
+/*
+ * Lock free byte queue for 1 producer (AudioThread) and 1 consumer (PortAudio callback).
+ * Positions increase monotonically and wrap around as unsigned int. capacity is power of 2.
+ * Ordered atomic operations are used because they are full memory barriers in both Qt4 and Qt5.
+ */
+class RingBuffer
+{
+public:
+    RingBuffer() : mask(0), read_pos(0), write_pos(0) {}
+    // not thread safe
+    void reset(int size) {
+        int capacity = 1;
+        while (capacity < size)
+            capacity <<= 1;
+        buf = QByteArray(capacity, 0);
+        mask = capacity - 1;
+        read_pos.fetchAndStoreOrdered(0);
+        write_pos.fetchAndStoreOrdered(0);
+    }
+    // not thread safe
+    void clear() {
+        read_pos.fetchAndStoreOrdered(0);
+        write_pos.fetchAndStoreOrdered(0);
+    }
+    int capacity() const { return buf.size(); }
+    int size() const {
+        return int((uint)write_pos.fetchAndAddOrdered(0) - (uint)read_pos.fetchAndAddOrdered(0));
+    }
+    int freeSize() const { return capacity() - size(); }
+    // producer only
+    int write(const char *data, int len) {
+        const uint w = write_pos.fetchAndAddOrdered(0);
+        const uint r = read_pos.fetchAndAddOrdered(0);
+        len = qMin(len, capacity() - int(w - r));
+        if (len <= 0)
+            return 0;
+        const int pos = int(w & mask);
+        const int n1 = qMin(len, capacity() - pos);
+        memcpy(buf.data() + pos, data, n1);
+        memcpy(buf.data(), data + n1, len - n1);
+        write_pos.fetchAndStoreOrdered(int(w + len));
+        return len;
+    }
+    // consumer only
+    int read(char *data, int len) {
+        const uint r = read_pos.fetchAndAddOrdered(0);
+        const uint w = write_pos.fetchAndAddOrdered(0);
+        len = qMin(len, int(w - r));
+        if (len <= 0)
+            return 0;
+        const int pos = int(r & mask);
+        const int n1 = qMin(len, capacity() - pos);
+        memcpy(data, buf.constData() + pos, n1);
+        memcpy(data + n1, buf.constData(), len - n1);
+        read_pos.fetchAndStoreOrdered(int(r + len));
+        return len;
+    }
+
+private:
+    QByteArray buf;
+    int mask;
+    mutable QAtomicInt read_pos, write_pos;
+};
+
 class AudioOutputPortAudioPrivate : public AudioOutputPrivate
 {
 public:
@@ -43,6 +109,17 @@ public:
         initialized(false)
       ,outputParameters(new PaStreamParameters)
       ,stream(0)
+      ,outputLatency(0)
+      ,buffer_duration(0.2)
+      ,device_latency(0)
+      ,silence(0)
+      ,frame_bytes(1)
+      ,written_frames(0)
+      ,starving(false)
+      ,underruns(0)
+      ,played_seq(0)
+      ,played_frames(0)
+      ,dac_latency(0)
     {
         PaError err = paNoError;
         if ((err = Pa_Initialize()) != paNoError) {
@@ -74,7 +151,7 @@ public:
         qDebug("DEFAULT max in/out channels: %d/%d", deviceInfo->maxInputChannels, deviceInfo->maxOutputChannels);
         qDebug("audio device: %s", QString::fromLocal8Bit(Pa_GetDeviceInfo(outputParameters->device)->name).toUtf8().constData());
         outputParameters->hostApiSpecificStreamInfo = NULL;
-        outputParameters->suggestedLatency = Pa_GetDeviceInfo(outputParameters->device)->defaultHighOutputLatency;
+        outputParameters->suggestedLatency = Pa_GetDeviceInfo(outputParameters->device)->defaultLowOutputLatency;
     }
     ~AudioOutputPortAudioPrivate() {
         if (initialized)
@@ -84,13 +161,76 @@ public:
             outputParameters = 0;
         }
     }
+    // called by the callback only. single writer seqlock
+    void publishPlayed(qint64 frames, double latency) {
+        played_seq.fetchAndAddOrdered(1);
+        played_frames = frames;
+        dac_latency = latency;
+        played_seq.fetchAndAddOrdered(1);
+    }
+    void played(qint64 *frames, double *latency) const {
+        forever {
+            const int s0 = played_seq.fetchAndAddOrdered(0);
+            if (s0 & 1) {
+                QThread::yieldCurrentThread();
+                continue;
+            }
+            *frames = played_frames;
+            *latency = dac_latency;
+            if (played_seq.fetchAndAddOrdered(0) == s0)
+                return;
+        }
+    }
 
     bool initialized;
     PaStreamParameters *outputParameters;
     PaStream *stream;
     double outputLatency;
+    qreal buffer_duration;
+    qreal device_latency;
+    char silence; // 0x80 for unsigned 8 bit
+    int frame_bytes;
+    RingBuffer ring;
+    // producer side
+    qint64 written_frames;
+    QMutex wait_mutex;
+    QWaitCondition wait_cond;
+    // consumer side
+    bool starving;
+    mutable QAtomicInt underruns;
+    mutable QAtomicInt played_seq;
+    qint64 played_frames;
+    double dac_latency;
 };
 
+// realtime thread. no lock, no allocation
+static int portAudioCallback(const void *input, void *output, unsigned long frameCount
+                             , const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags
+                             , void *userData)
+{
+    Q_UNUSED(input);
+    AudioOutputPortAudioPrivate *d = static_cast<AudioOutputPortAudioPrivate*>(userData);
+    const int bytes = int(frameCount) * d->frame_bytes;
+    const int got = d->ring.read((char*)output, bytes);
+    if (got < bytes) {
+        memset((char*)output + got, d->silence, bytes - got);
+        // count once for each starvation, e.g. pause is 1 underrun
+        if (!d->starving)
+            d->underruns.fetchAndAddOrdered(1);
+        d->starving = true;
+    } else {
+        d->starving = false;
+    }
+    if (statusFlags & paOutputUnderflow)
+        d->underruns.fetchAndAddOrdered(1);
+    double latency = d->outputLatency;
+    if (timeInfo && timeInfo->outputBufferDacTime > timeInfo->currentTime)
+        latency = timeInfo->outputBufferDacTime - timeInfo->currentTime;
+    // the callback is the only writer, so played_frames can be read directly
+    d->publishPlayed(d->played_frames + got/d->frame_bytes, latency);
+    return paContinue;
+}
+
 AudioOutputPortAudio::AudioOutputPortAudio()
     :AudioOutput(*new AudioOutputPortAudioPrivate())
 {
@@ -101,30 +241,110 @@ AudioOutputPortAudio::~AudioOutputPortAudio()
     close();
 }
 
-bool AudioOutputPortAudio::write()
+void AudioOutputPortAudio::setBufferDuration(qreal seconds)
+{
+    d_func().buffer_duration = qMax<qreal>(seconds, 0.01);
+}
+
+qreal AudioOutputPortAudio::bufferDuration() const
+{
+    return d_func().buffer_duration;
+}
+
+void AudioOutputPortAudio::setDeviceLatency(qreal seconds)
+{
+    d_func().device_latency = seconds;
+}
+
+qreal AudioOutputPortAudio::deviceLatency() const
+{
+    return d_func().device_latency;
+}
+
+int AudioOutputPortAudio::underruns() const
+{
+    return d_func().underruns.fetchAndAddOrdered(0);
+}
+
+qint64 AudioOutputPortAudio::playedSamples() const
+{
+    qint64 frames = 0;
+    double dac = 0;
+    d_func().played(&frames, &dac);
+    return frames;
+}
+
+qreal AudioOutputPortAudio::latency() const
+{
+    DPTR_D(const AudioOutputPortAudio);
+    if (!d.available || !d.stream || d.format.sampleRate() <= 0)
+        return 0;
+    qint64 frames = 0;
+    double dac = 0;
+    d.played(&frames, &dac);
+    return qreal(d.written_frames - frames)/qreal(d.format.sampleRate()) + dac;
+}
+
+void AudioOutputPortAudio::clear()
 {
     DPTR_D(AudioOutputPortAudio);
     QMutexLocker lock(&d.mutex);
     Q_UNUSED(lock);
-    if (!d.available)
+    if (!d.stream)
+        return;
+    // the callback is not called after the stream is stopped, so the consumer side can be reset
+    if (Pa_IsStreamStopped(d.stream) == 0) {
+        PaError err = Pa_AbortStream(d.stream);
+        if (err != paNoError) {
+            qWarning("Abort portaudio stream error: %s", Pa_GetErrorText(err));
+            return;
+        }
+    }
+    d.ring.clear();
+    d.written_frames = 0;
+    d.starving = false;
+    d.publishPlayed(0, 0);
+}
+
+/*
+ * Copy the data to the ring buffer and return. Block only if the ring buffer is full,
+ * so the audio thread is paced by the device and can decode ahead of the device latency
+ */
+bool AudioOutputPortAudio::write()
+{
+    DPTR_D(AudioOutputPortAudio);
+    if (!d.available || !d.stream)
         return false;
-    if (Pa_IsStreamStopped(d.stream))
-        Pa_StartStream(d.stream);
-#if KNOW_WHY
-#ifndef Q_OS_MAC //?
-    int diff = Pa_GetStreamWriteAvailable(d.stream) - d.outputLatency * d.sample_rate;
-    if (diff > 0) {
-        int newsize = diff * d.channels * sizeof(float);
-        static char *a = new char[newsize];
-        memset(a, 0, newsize);
-        Pa_WriteStream(d.stream, a, diff);
-    }
-#endif
-#endif //KNOW_WHY
-    PaError err = Pa_WriteStream(d.stream, d.data.data(), d.data.size()/audioFormat().channels()/audioFormat().bytesPerSample());
-    if (err == paUnanticipatedHostError) {
-        qWarning("Write portaudio stream error: %s", Pa_GetErrorText(err));
-        return   false;
+    const char *data = d.data.constData();
+    int remain = d.data.size();
+    const int byte_rate = audioFormat().bytesPerSecond();
+    while (remain > 0) {
+        const int n = d.ring.write(data, remain);
+        data += n;
+        remain -= n;
+        if (remain <= 0)
+            break;
+        if (Pa_IsStreamStopped(d.stream) == 1) {
+            PaError err = Pa_StartStream(d.stream);
+            if (err != paNoError) {
+                qWarning("Start portaudio stream error: %s", Pa_GetErrorText(err));
+                return false;
+            }
+        }
+        // no wake up from the callback. wait for the time to play the missing data
+        QMutexLocker lock(&d.wait_mutex);
+        Q_UNUSED(lock);
+        d.wait_cond.wait(&d.wait_mutex, qBound<ulong>(1UL, ulong(qint64(remain)*1000LL/qMax(byte_rate, 1)), 20UL));
+        if (!d.available)
+            return false;
+    }
+    d.written_frames += d.data.size()/d.frame_bytes;
+    if (Pa_IsStreamStopped(d.stream) == 1) {
+        PaError err = Pa_StartStream(d.stream);
+        if (err != paNoError) {
+            qWarning("Start portaudio stream error: %s", Pa_GetErrorText(err));
+            return false;
+        }
     }
     return true;
 }
@@ -153,7 +373,19 @@ bool AudioOutputPortAudio::open()
     Q_UNUSED(lock);
     d.outputParameters->sampleFormat = toPaSampleFormat(audioFormat().sampleFormat());
     d.outputParameters->channelCount = audioFormat().channels();
-    PaError err = Pa_OpenStream(&d.stream, NULL, d.outputParameters, audioFormat().sampleRate(), 0, paNoFlag, NULL, NULL);
+    if (d.device_latency > 0)
+        d.outputParameters->suggestedLatency = d.device_latency;
+    else
+        d.outputParameters->suggestedLatency = Pa_GetDeviceInfo(d.outputParameters->device)->defaultLowOutputLatency;
+    d.silence = d.outputParameters->sampleFormat == paUInt8 ? char(0x80) : 0;
+    d.frame_bytes = qMax(audioFormat().bytesPerFrame(), 1);
+    d.ring.reset(qMax(int(d.buffer_duration*qreal(audioFormat().bytesPerSecond())), 4096));
+    d.written_frames = 0;
+    d.starving = false;
+    d.underruns.fetchAndStoreOrdered(0);
+    d.publishPlayed(0, 0);
+    PaError err = Pa_OpenStream(&d.stream, NULL, d.outputParameters, audioFormat().sampleRate()
+                                , paFramesPerBufferUnspecified, paNoFlag, portAudioCallback, &d);
     if (err == paNoError) {
         d.outputLatency = Pa_GetStreamInfo(d.stream)->outputLatency;
         d.available = true;
@@ -171,6 +403,7 @@ bool AudioOutputPortAudio::close()
     Q_UNUSED(lock);
     bool available_old = d.available;
     d.available = false;
+    d.wait_cond.wakeAll();
     PaError err = paNoError;
     if (!d.stream) {
         return true;
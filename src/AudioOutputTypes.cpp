@@ -7,6 +7,7 @@ namespace QtAV {
 AudioOutputId AudioOutputId_PortAudio = 1;
 AudioOutputId AudioOutputId_OpenAL = 2;
 AudioOutputId AudioOutputId_OpenSL = 3;
+AudioOutputId AudioOutputId_Null = 4;
 
 QVector<AudioOutputId> GetRegistedAudioOutputIds()
 {
@@ -19,6 +20,7 @@ FACTORY_DEFINE(AudioOutput)
 extern void RegisterAudioOutputPortAudio_Man();
 extern void RegisterAudioOutputOpenAL_Man();
 extern void RegisterAudioOutputOpenSL_Man();
+extern void RegisterAudioOutputNull_Man();
 
 void AudioOutput_RegisterAll()
 {
@@ -31,6 +33,7 @@ void AudioOutput_RegisterAll()
 #if QTAV_HAVE(OPENSL)
     RegisterAudioOutputOpenSL_Man();
 #endif //QTAV_HAVE(OPENSL)
+    RegisterAudioOutputNull_Man();
 }
 
 } //namespace QtAV
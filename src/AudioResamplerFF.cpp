@@ -2,6 +2,7 @@
 #include "AudioResampler.h"
 #include "private/AudioResampler_p.h"
 #include "QtAV/QtAV_Compat.h"
+#include "QtAV/Logging.h"
 #include "prepost.h"
 
 namespace QtAV {
@@ -72,7 +73,7 @@ bool AudioResamplerFF::convert(const quint8 **data)
     //number of input/output samples available in one channel
     int converted_samplers_per_channel = swr_convert(d.context, out, d.out_samples_per_channel, data, d.in_samples_per_channel);
     if (converted_samplers_per_channel < 0) {
-        qWarning("[AudioResamplerFF] %s", av_err2str(converted_samplers_per_channel));
+        QTAV_WARNING_LIMITED(LogAudio, "[AudioResamplerFF] %s", av_err2str(converted_samplers_per_channel));
         return false;
     }
     //TODO: converted_samplers_per_channel==out_samples_per_channel means out_size is too small, see mplayer2
@@ -21,13 +21,20 @@
 
 #include <QtAV/AudioThread.h>
 #include <private/AVThread_p.h>
+#include <private/AudioDSP_p.h>
 #include <QtAV/AudioDecoder.h>
 #include <QtAV/Packet.h>
 #include <QtAV/AudioFormat.h>
+#include <QtAV/AudioFrame.h>
 #include <QtAV/AudioOutput.h>
 #include <QtAV/AudioResampler.h>
+#include <QtAV/AudioTimeStretcher.h>
 #include <QtAV/AVClock.h>
+#include <QtAV/Filter.h>
+#include <QtAV/Logging.h>
 #include <QtAV/OutputSet.h>
+#include <QtAV/Statistics.h>
+#include <QtAV/Tracer.h>
 #include <QtAV/QtAV_Compat.h>
 #include <QtCore/QCoreApplication>
 
@@ -39,10 +46,14 @@ public:
     void init() {
         resample = false;
         last_pts = 0;
+        no_ao_deadline = -1;
+        stretcher.reset();
     }
 
     bool resample;
     qreal last_pts; //used when audio output is not available, to calculate the aproximate sleeping time
+    qint64 no_ao_deadline; //monotonic time to play the next chunk if audio output is not available
+    AudioTimeStretcher stretcher;
 };
 
 AudioThread::AudioThread(QObject *parent)
@@ -71,6 +82,7 @@ void AudioThread::run()
     d.init();
     //TODO: bool need_sync in private class
     bool is_external_clock = d.clock->clockType() == AVClock::ExternalClock;
+    Statistics::Pipeline pipeline = d.statistics ? d.statistics->audio_pipeline : Statistics::Pipeline();
     Packet pkt;
     while (!d.stop) {
         processNextTask();
@@ -86,18 +98,26 @@ void AudioThread::run()
             d.stop = d.demux_end;
         }
         if (d.stop) {
-            qDebug("audio thread stop before take packet");
+            QTAV_DEBUG(LogAudio, "audio thread stop before take packet");
             break;
         }
         if (!pkt.isValid()) {
             pkt = d.packets.take(); //wait to dequeue
+            pipeline.setQueueDepth(d.packets.size());
+            if (pkt.isValid() && pkt.read_time > 0)
+                pipeline.addLatency(Statistics::Pipeline::Queue, Statistics::timestamp() - pkt.read_time);
         }
         if (!pkt.isValid()) {
-            qDebug("Invalid packet! flush audio codec context!!!!!!!! audio queue size=%d", d.packets.size());
+            QTAV_DEBUG_LIMITED(LogAudio, "Invalid packet! flush audio codec context!!!!!!!! audio queue size=%d", d.packets.size());
             dec->flush();
+            d.stretcher.reset();
+            // the samples queued in the output are before the seek position
+            if (ao && ao->isAvailable())
+                ao->clear();
             continue;
         }
-        if (is_external_clock) {
+        // free run: not paced by the clock. the clock follows the decoded packets
+        if (is_external_clock && !d.free_run) {
             d.delay = pkt.pts - d.clock->value();
             /*
              *after seeking forward, a packet may be the old, v packet may be
@@ -109,21 +129,14 @@ void AudioThread::run()
                 if (d.delay < -kSyncThreshold) { //Speed up. drop frame?
                     //continue;
                 }
-                while (d.delay > kSyncThreshold) { //Slow down
-                    //d.delay_cond.wait(&d.mutex, d.delay*1000); //replay may fail. why?
-                    //qDebug("~~~~~wating for %f msecs", d.delay*1000);
-                    usleep(kSyncThreshold * 1000000UL);
-                    if (d.stop)
-                        d.delay = 0;
-                    else
-                        d.delay -= kSyncThreshold;
-                }
-                if (d.delay > 0)
-                    usleep(d.delay * 1000000UL);
+                // interrupted by stop, pause or seek. check the state and schedule again
+                if (d.delay > 0 && !waitFor(d.delay))
+                    continue;
             } else { //when to drop off?
-                qDebug("delay %f/%f", d.delay, d.clock->value());
+                QTAV_DEBUG_LIMITED(LogAudio, "delay %f/%f", d.delay, d.clock->value());
                 if (d.delay > 0) {
-                    msleep(64);
+                    if (!waitFor(0.064))
+                        continue;
                 } else {
                     //audio packet not cleaned up?
                     continue;
@@ -133,28 +146,22 @@ void AudioThread::run()
             d.clock->updateValue(pkt.pts);
         }
         //DO NOT decode and convert if ao is not available or mute!
-        bool has_ao = ao && ao->isAvailable();
+        // free run: a device plays in realtime. the decoded audio is sent to filters and outputs without device timing
+        bool has_ao = ao && ao->isAvailable() && (!d.free_run || !ao->isRealtime());
         //if (!has_ao) {//do not decode?
         // TODO: move resampler to AudioFrame, like VideoFrame does
-        if (has_ao && dec->resampler()) {
-            if (dec->resampler()->speed() != ao->speed()
-                    || dec->resampler()->outAudioFormat() != ao->audioFormat()) {
+        // speed is applied by the time-stretcher if possible, so the resampler is not recreated and the pitch is kept
+        const bool stretch = has_ao && AudioTimeStretcher::isSupported(ao->audioFormat());
+        if (dec->resampler()) {
+            const qreal resample_speed = has_ao && !stretch ? ao->speed() : 1.0;
+            if (dec->resampler()->speed() != resample_speed
+                    || (has_ao && dec->resampler()->outAudioFormat() != ao->audioFormat())) {
                 //resample later to ensure thread safe. TODO: test
                 if (d.resample) {
-                    qDebug("decoder set speed: %.2f", ao->speed());
-                    dec->resampler()->setOutAudioFormat(ao->audioFormat());
-                    dec->resampler()->setSpeed(ao->speed());
-                    dec->resampler()->prepare();
-                    d.resample = false;
-                } else {
-                    d.resample = true;
-                }
-            }
-        } else {
-            if (dec->resampler() && dec->resampler()->speed() != d.clock->speed()) {
-                if (d.resample) {
-                    qDebug("decoder set speed: %.2f", d.clock->speed());
-                    dec->resampler()->setSpeed(d.clock->speed());
+                    QTAV_DEBUG(LogAudio, "decoder set speed: %.2f", resample_speed);
+                    if (has_ao)
+                        dec->resampler()->setOutAudioFormat(ao->audioFormat());
+                    dec->resampler()->setSpeed(resample_speed);
                     dec->resampler()->prepare();
                     d.resample = false;
                 } else {
@@ -163,15 +170,21 @@ void AudioThread::run()
             }
         }
         if (d.stop) {
-            qDebug("audio thread stop before decode()");
+            QTAV_DEBUG(LogAudio, "audio thread stop before decode()");
             break;
         }
         QMutexLocker locker(&d.mutex);
         Q_UNUSED(locker);
-        if (!dec->decode(pkt.data)) {
-            qWarning("Decode audio failed");
+        const qint64 decode_start = Statistics::timestamp();
+        bool decoded = false;
+        {
+            Tracer::Scope trace("decode", "audio", pkt.pts);
+            decoded = dec->decode(pkt.data);
+        }
+        if (!decoded) {
+            QTAV_WARNING_LIMITED(LogAudio, "Decode audio failed");
             qreal dt = pkt.pts - d.last_pts;
-            if (dt > 0.618 || dt < 0) {
+            if (dt > 0.618 || dt < 0 || d.free_run) {
                 dt = 0;
             }
             //qDebug("sleep %f", dt);
@@ -181,69 +194,65 @@ void AudioThread::run()
             d.last_pts = d.clock->value(); //not pkt.pts! the delay is updated!
             continue;
         }
-        QByteArray decoded(dec->data());
-        int decodedSize = decoded.size();
-        int decodedPos = 0;
-        qreal delay =0;
-        //AudioFormat.durationForBytes() calculates int type internally. not accurate
-        AudioFormat &af = dec->resampler()->inAudioFormat();
-        qreal byte_rate = af.bytesPerSecond();
-        while (decodedSize > 0) {
+        // shares the decoder buffer. chunks and filters do not copy
+        AudioFrame frame(dec->frame());
+        frame.setTimestamp(pkt.pts);
+        pipeline.addLatency(Statistics::Pipeline::Decode, Statistics::timestamp() - decode_start);
+        if (!d.filters.isEmpty()) {
+            const qint64 filter_start = Statistics::timestamp();
+            foreach (Filter *filter, d.filters) {
+                if (d.stop)
+                    break;
+                if (!filter->isEnabled())
+                    continue;
+                filter->process(d.filter_context, d.statistics, &frame);
+            }
+            pipeline.addLatency(Statistics::Pipeline::Filter, Statistics::timestamp() - filter_start);
+        }
+        qreal delay = 0;
+        if (stretch) {
+            d.stretcher.setSpeed(ao->speed());
+            if (d.stretcher.isActive()) {
+                // the output starts with the samples buffered from previous packets
+                delay = -d.stretcher.pendingDuration();
+                frame = d.stretcher.process(frame);
+            }
+        }
+        // media time of 1s output. no audio output: speed is applied by waiting
+        const qreal media_scale = has_ao ? ao->speed() : 1.0;
+        const AudioFormat af = frame.format();
+        const int samples = frame.isValid() ? frame.samplesPerChannel() : 0;
+        const int max_samples = qMax(int(max_len*af.sampleRate()), 1);
+        int pos = 0;
+        qint64 render_time = 0;
+        while (pos < samples) {
             if (d.stop) {
-                qDebug("audio thread stop after decode()");
+                QTAV_DEBUG(LogAudio, "audio thread stop after decode()");
                 break;
             }
-            int chunk = qMin(decodedSize, int(max_len*byte_rate));
-            //AudioFormat.bytesForDuration
-            qreal chunk_delay = (qreal)chunk/(qreal)byte_rate;
-            pkt.pts += chunk_delay;
-            d.clock->updateDelay(delay += chunk_delay);
-            QByteArray decodedChunk(chunk, 0); //volume == 0 || mute
+            const int chunk = qMin(samples - pos, max_samples);
+            qreal chunk_delay = (qreal)chunk/(qreal)af.sampleRate();
+            pkt.pts += chunk_delay*media_scale;
+            d.clock->updateDelay(delay += chunk_delay*media_scale);
             if (has_ao) {
-                //TODO: volume filter and other filters!!!
-                if (!ao->isMute()) {
-                    decodedChunk = QByteArray::fromRawData(decoded.constData() + decodedPos, chunk);
-                    qreal vol = ao->volume();
-                    if (vol != 1.0) {
-                        int len = decodedChunk.size()/ao->audioFormat().bytesPerSample();
-                        switch (ao->audioFormat().sampleFormat()) {
-                        case AudioFormat::SampleFormat_Unsigned8:
-                        case AudioFormat::SampleFormat_Unsigned8Planar: {
-                            quint8 *data = (quint8*)decodedChunk.data(); //TODO: other format?
-                            for (int i = 0; i < len; data[i++] *= vol) {}
-                        }
-                            break;
-                        case AudioFormat::SampleFormat_Signed16:
-                        case AudioFormat::SampleFormat_Signed16Planar: {
-                            qint16 *data = (qint16*)decodedChunk.data(); //TODO: other format?
-                            for (int i = 0; i < len; data[i++] *= vol) {}
-                        }
-                            break;
-                        case AudioFormat::SampleFormat_Signed32:
-                        case AudioFormat::SampleFormat_Signed32Planar: {
-                            qint32 *data = (qint32*)decodedChunk.data(); //TODO: other format?
-                            for (int i = 0; i < len; data[i++] *= vol) {}
-                        }
-                            break;
-                        case AudioFormat::SampleFormat_Float:
-                        case AudioFormat::SampleFormat_FloatPlanar: {
-                            float *data = (float*)decodedChunk.data(); //TODO: other format?
-                            for (int i = 0; i < len; data[i++] *= vol) {}
-                        }
-                            break;
-                        case AudioFormat::SampleFormat_Double:
-                        case AudioFormat::SampleFormat_DoublePlanar: {
-                            double *data = (double*)decodedChunk.data(); //TODO: other format?
-                            for (int i = 0; i < len; data[i++] *= vol) {}
-                        }
-                            break;
-                        default:
-                            break;
-                        }
+                AudioFrame chunkFrame;
+                if (ao->isMute()) { //volume == 0 || mute
+                    chunkFrame = AudioFrame(QByteArray(chunk*af.bytesPerFrame(), 0), af);
+                } else {
+                    chunkFrame = frame.mid(pos, chunk);
+                    // the chunk shares the decoded data with filters and other outputs. scale a copy
+                    if (ao->volume() != 1.0) {
+                        chunkFrame = chunkFrame.clone();
+                        // vectorized, integer samples are saturated instead of wrapping
+                        AudioDSP::gain(&chunkFrame, ao->volume());
                     }
                 }
-                ao->receiveData(decodedChunk);
-            } else {
+                const qint64 render_start = Statistics::timestamp();
+                ao->receiveData(chunkFrame);
+                render_time += Statistics::timestamp() - render_start;
+                // audible time = the end of written data - data queued in device
+                d.clock->updateAudioLatency(ao->latency()*media_scale);
+            } else if (!d.free_run) {
             /*
              * why need this even if we add delay? and usleep sounds weird
              * the advantage is if no audio device, the play speed is ok too
@@ -251,15 +260,23 @@ void AudioThread::run()
              */
                 static bool sWarn_no_ao = true; //FIXME: no warning when replay. warn only once
                 if (sWarn_no_ao) {
-                    qDebug("Audio output not available! msleep(%lu)", (unsigned long)((qreal)chunk/(qreal)byte_rate * 1000));
+                    QTAV_DEBUG(LogAudio, "Audio output not available! msleep(%lu)", (unsigned long)(chunk_delay * 1000));
                     sWarn_no_ao = false;
                 }
-                //TODO: avoid acummulative error. External clock?
-                msleep((unsigned long)(chunk_delay * 1000.0));
+                // absolute deadline, no accumulative error. restart if far behind, e.g. after pause or seek
+                const qint64 now = monotonicTime();
+                if (d.no_ao_deadline < 0 || now - d.no_ao_deadline > 100000LL)
+                    d.no_ao_deadline = now;
+                // the clock speed is negative when rewinding
+                d.no_ao_deadline += qint64(chunk_delay/qMax(qAbs(d.clock->speed()), 0.01) * 1000000.0);
+                waitUntil(d.no_ao_deadline);
             }
-            decodedPos += chunk;
-            decodedSize -= chunk;
+            pos += chunk;
         }
+        if (has_ao && samples > 0)
+            pipeline.addLatency(Statistics::Pipeline::Render, render_time);
+        if (pkt.read_time > 0)
+            pipeline.addLatency(Statistics::Pipeline::Total, Statistics::timestamp() - pkt.read_time);
         int undecoded = dec->undecodedSize();
         if (undecoded > 0) {
             pkt.data.remove(0, pkt.data.size() - undecoded);
@@ -0,0 +1,264 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/AudioTimeStretcher.h"
+#include "QtAV/AudioFormat.h"
+#include "QtAV/AudioFrame.h"
+#include "private/AudioDSP_p.h"
+#include <QtCore/QVector>
+#include <QtCore/qmath.h>
+#include <string.h>
+
+namespace QtAV {
+
+// overlap of 2 output segments. longer is smoother for music but more echo for speech
+static const qreal kOverlap = 0.02;
+// max offset from the nominal position when searching the most similar segment
+static const qreal kSeekWindow = 0.01;
+
+class AudioTimeStretcherPrivate : public DPtrPrivate<AudioTimeStretcher>
+{
+public:
+    AudioTimeStretcherPrivate():
+        speed(1.0)
+      , channels(0)
+      , sample_rate(0)
+      , overlap(0)
+      , seek(0)
+      , in_frames(0)
+      , in_base(0)
+      , prev_best(0)
+      , nominal(0)
+      , started(false)
+    {
+        format.setSampleFormat(AudioFormat::SampleFormat_Unknown);
+    }
+    void init(const AudioFormat& fmt) {
+        format = fmt;
+        channels = fmt.channels();
+        sample_rate = fmt.sampleRate();
+        overlap = qMax(int(kOverlap*qreal(sample_rate)), 16);
+        seek = qMax(int(kSeekWindow*qreal(sample_rate)), 4);
+        // raised cosine, expanded to interleaved samples so that the crossfade kernel is a plain vector op
+        window.resize(overlap*channels);
+        for (int i = 0; i < overlap; ++i) {
+            const float w = 0.5f - 0.5f*(float)qCos(M_PI*(qreal(i) + 0.5)/qreal(overlap));
+            for (int c = 0; c < channels; ++c)
+                window[i*channels + c] = w;
+        }
+        reset();
+    }
+    void reset() {
+        input.resize(0);
+        in_frames = 0;
+        in_base = 0;
+        started = false;
+    }
+    void append(const float *src, int frames) {
+        input.resize((in_frames + frames)*channels);
+        memcpy(input.data() + in_frames*channels, src, frames*channels*sizeof(float));
+        in_frames += frames;
+    }
+    // drop input frames before position
+    void discard(qint64 position) {
+        const int n = (int)qBound<qint64>(0, position - in_base, in_frames);
+        if (n <= 0)
+            return;
+        in_frames -= n;
+        in_base += n;
+        memmove(input.data(), input.constData() + n*channels, in_frames*channels*sizeof(float));
+        input.resize(in_frames*channels);
+    }
+    /*!
+     * WSOLA: the segment following the last used one (its natural continuation) is the template.
+     * Search the segment most similar to the template around the nominal position, and crossfade
+     * from the template to it. So the output advances overlap frames and the input advances overlap*speed.
+     */
+    bool step(QByteArray *out) {
+        const qint64 q = qRound64(nominal);
+        const qint64 lo = qMax(q - seek, in_base);
+        const qint64 hi = qMax(q + seek, lo);
+        const qint64 in_end = in_base + in_frames;
+        if (hi + overlap > in_end || prev_best + 2*overlap > in_end)
+            return false;
+        const int n = overlap*channels;
+        const float *base = input.constData();
+        const float *tmpl = base + (prev_best + overlap - in_base)*channels;
+        // energy of candidate k is E[k+overlap-lo] - E[k-lo]
+        const int span = int(hi + overlap - lo);
+        energy.resize(span + 1);
+        energy[0] = 0;
+        const float *p = base + (lo - in_base)*channels;
+        for (int f = 0; f < span; ++f) {
+            double e = 0;
+            for (int c = 0; c < channels; ++c, ++p)
+                e += double(*p)*double(*p);
+            energy[f+1] = energy[f] + e;
+        }
+        qint64 best = qBound(lo, q, hi);
+        double best_score = -1e300;
+        // coarse search on even offsets, then refine the neighbours
+        for (qint64 k = lo; k <= hi; k += 2) {
+            const double s = score(tmpl, k, lo, n);
+            if (s > best_score) {
+                best_score = s;
+                best = k;
+            }
+        }
+        const qint64 coarse = best;
+        for (qint64 k = coarse - 1; k <= coarse + 1; k += 2) {
+            if (k < lo || k > hi)
+                continue;
+            const double s = score(tmpl, k, lo, n);
+            if (s > best_score) {
+                best_score = s;
+                best = k;
+            }
+        }
+        const int old = out->size();
+        out->resize(old + n*(int)sizeof(float));
+        AudioDSP::crossfade(tmpl, base + (best - in_base)*channels, window.constData(), (float*)(out->data() + old), n);
+        prev_best = best;
+        nominal += qreal(overlap)*speed;
+        discard(qMin(prev_best + overlap, qRound64(nominal) - seek));
+        return true;
+    }
+    double score(const float *tmpl, qint64 k, qint64 lo, int n) const {
+        const double e = energy[int(k - lo) + overlap] - energy[int(k - lo)];
+        return double(AudioDSP::dot(tmpl, input.constData() + (k - in_base)*channels, n))/qSqrt(e + 1e-9);
+    }
+
+    qreal speed;
+    AudioFormat format;
+    int channels;
+    int sample_rate;
+    int overlap; // frames
+    int seek; // frames
+    QVector<float> window;
+    QVector<float> input; // interleaved float
+    int in_frames;
+    qint64 in_base; // stream position of input[0], in frames
+    qint64 prev_best; // stream position of the last used segment
+    qreal nominal; // stream position of the next segment if no search
+    bool started;
+    QVector<double> energy;
+    QVector<float> converted;
+};
+
+AudioTimeStretcher::AudioTimeStretcher()
+{
+}
+
+AudioTimeStretcher::~AudioTimeStretcher()
+{
+}
+
+bool AudioTimeStretcher::isSupported(const AudioFormat &format)
+{
+    return format.isValid() && (format.sampleFormat() == AudioFormat::SampleFormat_Float
+                                || format.sampleFormat() == AudioFormat::SampleFormat_Signed16);
+}
+
+void AudioTimeStretcher::setSpeed(qreal speed)
+{
+    DPTR_D(AudioTimeStretcher);
+    if (speed <= 0)
+        return;
+    d.speed = speed;
+}
+
+qreal AudioTimeStretcher::speed() const
+{
+    return d_func().speed;
+}
+
+bool AudioTimeStretcher::isActive() const
+{
+    DPTR_D(const AudioTimeStretcher);
+    return d.speed != 1.0 || d.started;
+}
+
+AudioFrame AudioTimeStretcher::process(const AudioFrame &frame)
+{
+    DPTR_D(AudioTimeStretcher);
+    if (!frame.isValid())
+        return frame;
+    const AudioFormat fmt(frame.format());
+    if (!isSupported(fmt))
+        return frame;
+    if (fmt.sampleFormat() != d.format.sampleFormat() || fmt.channels() != d.channels || fmt.sampleRate() != d.sample_rate)
+        d.init(fmt);
+    if (!isActive())
+        return frame;
+    // the output starts at the input held back by the previous calls, not at this frame
+    const qreal pending = pendingDuration();
+    const int frames = frame.samplesPerChannel();
+    const int count = frames*d.channels;
+    if (fmt.sampleFormat() == AudioFormat::SampleFormat_Signed16) {
+        d.converted.resize(count);
+        AudioDSP::s16ToFloat((const qint16*)frame.bits(0), d.converted.data(), count);
+        d.append(d.converted.constData(), frames);
+    } else {
+        d.append((const float*)frame.bits(0), frames);
+    }
+    if (!d.started) {
+        // the first template is the first input segment. the search finds it at offset 0, so no click at the start
+        d.started = true;
+        d.prev_best = d.in_base - d.overlap;
+        d.nominal = d.in_base;
+    }
+    QByteArray out;
+    if (d.speed == 1.0) {
+        // flush. the template is the natural continuation of the output, so the rest of input follows seamlessly
+        const int from = int(d.prev_best + d.overlap - d.in_base);
+        out = QByteArray((const char*)(d.input.constData() + from*d.channels), (d.in_frames - from)*d.channels*(int)sizeof(float));
+        d.reset();
+    } else {
+        out.reserve((int(qreal(frames)/d.speed) + d.overlap)*d.channels*(int)sizeof(float));
+        while (d.step(&out)) {}
+    }
+    if (fmt.sampleFormat() == AudioFormat::SampleFormat_Signed16) {
+        const int n = out.size()/(int)sizeof(float);
+        QByteArray s16;
+        s16.resize(n*(int)sizeof(qint16));
+        AudioDSP::floatToS16((const float*)out.constData(), (qint16*)s16.data(), n);
+        out = s16;
+    }
+    AudioFrame stretched(out, fmt);
+    stretched.setTimestamp(frame.timestamp() - pending);
+    return stretched;
+}
+
+qreal AudioTimeStretcher::pendingDuration() const
+{
+    DPTR_D(const AudioTimeStretcher);
+    if (!d.started || d.sample_rate <= 0)
+        return 0;
+    return qMax<qreal>(0, qreal(d.in_base + d.in_frames) - d.nominal)/qreal(d.sample_rate);
+}
+
+void AudioTimeStretcher::reset()
+{
+    DPTR_D(AudioTimeStretcher);
+    d.reset();
+}
+
+} //namespace QtAV
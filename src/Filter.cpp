@@ -22,6 +22,7 @@
 #include "QtAV/Filter.h"
 #include "private/Filter_p.h"
 #include "QtAV/Statistics.h"
+#include "QtAV/Tracer.h"
 #include "QtAV/FilterManager.h"
 #include "QtAV/AVOutput.h"
 #include "QtAV/AVPlayer.h"
@@ -54,6 +55,7 @@ Filter::~Filter()
 //copy qpainter if context nut null
 void Filter::process(FilterContext *&context, Statistics *statistics, Frame* frame)
 {
+    Tracer::Scope trace("process", "filter");
     if (contextType() == FilterContext::None) {
         process(statistics, frame);
         return;
@@ -63,6 +63,16 @@ QByteArray Frame::frameData() const
     return d_func()->data;
 }
 
+void Frame::setBufferRef(FrameBufferRef *ref)
+{
+    d_func()->buffer_ref = QExplicitlySharedDataPointer<FrameBufferRef>(ref);
+}
+
+bool Frame::isBufferOwned() const
+{
+    return !d_func()->data.isEmpty() || d_func()->buffer_ref.data();
+}
+
 QByteArray Frame::data(int plane) const
 {
     if (plane < 0 || plane >= planeCount()) {
@@ -0,0 +1,556 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/FrameExtractor.h"
+#include <limits>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QtAlgorithms>
+#include "QtAV/AVDemuxer.h"
+#include "QtAV/ImageConverter.h"
+#include "QtAV/ImageConverterTypes.h"
+#include "QtAV/Packet.h"
+#include "QtAV/VideoDecoder.h"
+#include "QtAV/VideoDecoderTypes.h"
+#include "QtAV/WorkerPool.h"
+#include "QtAV/QtAV_Compat.h"
+
+namespace QtAV {
+
+// consecutive reads without a packet
+static const int kMaxSkippedReads = 512;
+// video packets read after a seek before a key frame is found
+static const int kMaxPackets = 1024;
+// delayed frames in decoder
+static const int kMaxDrain = 64;
+// 1/8 size
+static const int kMaxLowResolution = 3;
+
+struct ExtractOptions {
+    VideoFormat::PixelFormat format;
+    QSize size;
+    bool key_only;
+    bool lowres;
+};
+
+// a demuxer, a decoder and a converter. reused for the next file
+class ExtractWorker
+{
+public:
+    ExtractWorker() : decoder(0), conv(0), frame_duration(0.04) {}
+    ~ExtractWorker() {
+        close();
+        if (decoder) {
+            delete decoder;
+            decoder = 0;
+        }
+        if (conv) {
+            delete conv;
+            conv = 0;
+        }
+    }
+    bool open(const QString& file, const ExtractOptions& opt);
+    void close();
+    /*!
+     * the frame at pos(ms). if opt.key_only, the key frame at or before pos, and after min_pts(seconds),
+     * or the next key frame. pts: seconds
+     */
+    bool extract(qint64 pos, qreal min_pts, const ExtractOptions& opt, VideoFrame *frame, qreal *pts);
+
+    AVDemuxer demuxer;
+private:
+    // pts_list: pts of the packets sent to decoder. frames come out in display order
+    bool takeFrame(qreal t, const ExtractOptions& opt, QVector<qreal> *pts_list, VideoFrame *frame, qreal *pts);
+    VideoFrame convert(const VideoFrame& frame, const ExtractOptions& opt);
+
+    VideoDecoder *decoder;
+    ImageConverter *conv;
+    QSize out_size;
+    qreal frame_duration;
+};
+
+bool ExtractWorker::open(const QString &file, const ExtractOptions &opt)
+{
+    close();
+    if (!demuxer.loadFile(file)) {
+        qWarning("FrameExtractor: can not load %s", qPrintable(file));
+        return false;
+    }
+    AVCodecContext *ctx = demuxer.videoCodecContext();
+    if (!ctx || ctx->width <= 0 || ctx->height <= 0) {
+        qWarning("FrameExtractor: no video stream in %s", qPrintable(file));
+        demuxer.close();
+        return false;
+    }
+    // only video packets are read
+    AVFormatContext *fmt_ctx = demuxer.formatContext();
+    for (unsigned i = 0; i < fmt_ctx->nb_streams; ++i) {
+        if ((int)i != demuxer.videoStream())
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+    int w = ctx->width;
+    if (ctx->sample_aspect_ratio.num > 0 && ctx->sample_aspect_ratio.den > 0)
+        w = qMax(1, int(qreal(ctx->width)*av_q2d(ctx->sample_aspect_ratio)));
+    out_size = QSize(w, ctx->height);
+    // never scale up
+    if (opt.size.isValid() && (out_size.width() > opt.size.width() || out_size.height() > opt.size.height()))
+        out_size.scale(opt.size, Qt::KeepAspectRatio);
+    out_size = QSize(qMax(2, out_size.width() & ~1), qMax(2, out_size.height() & ~1));
+    int lowres = 0;
+    if (opt.lowres) {
+        while (lowres < kMaxLowResolution
+               && (w >> (lowres + 1)) >= out_size.width()
+               && (ctx->height >> (lowres + 1)) >= out_size.height())
+            ++lowres;
+    }
+    // frames are converted from decoder's buffer. hw decoders output surfaces
+    if (!decoder)
+        decoder = VideoDecoderFactory::create(VideoDecoderId_FFmpeg);
+    if (!decoder) {
+        demuxer.close();
+        return false;
+    }
+    // files are extracted in parallel. frame threads would also delay the output of the key frame
+    decoder->setDecodeThreads(1);
+    // limited by the decoder's max_lowres when opened
+    decoder->setLowResolution(lowres);
+    decoder->setCodecContext(ctx);
+    if (!decoder->prepare() || !decoder->open()) {
+        qWarning("FrameExtractor: can not open video decoder for %s", qPrintable(file));
+        decoder->setCodecContext(0);
+        demuxer.close();
+        return false;
+    }
+    frame_duration = demuxer.frameRate() > 0 ? 1.0/demuxer.frameRate() : 0.04;
+    return true;
+}
+
+void ExtractWorker::close()
+{
+    // avformat_close_input() does not close a codec opened by the caller. the context itself is owned by demuxer
+    if (decoder) {
+        decoder->close();
+        decoder->setCodecContext(0);
+    }
+    demuxer.close();
+}
+
+bool ExtractWorker::extract(qint64 pos, qreal min_pts, const ExtractOptions &opt, VideoFrame *frame, qreal *pts)
+{
+    if (!decoder || !decoder->isOpen())
+        return false;
+    if (!demuxer.seekToKeyFrame(pos))
+        return false;
+    decoder->flush();
+    const int video_stream = demuxer.videoStream();
+    const qreal t = qreal(pos)/1000.0;
+    QVector<qreal> pts_list;
+    bool started = false;
+    int skipped = 0;
+    int packets = 0;
+    forever {
+        if (!demuxer.readFrame()) {
+            if (demuxer.atEnd() || ++skipped > kMaxSkippedReads)
+                break;
+            continue;
+        }
+        skipped = 0;
+        const Packet *pkt = demuxer.packet();
+        if (pkt->isEnd())
+            break;
+        if (demuxer.stream() != video_stream)
+            continue;
+        if (!started) {
+            // the key frame before min_pts is already extracted. use the next one
+            if (!pkt->hasKeyFrame || pkt->pts <= min_pts) {
+                if (++packets > kMaxPackets)
+                    return false;
+                continue;
+            }
+            started = true;
+        }
+        pts_list.append(pkt->pts);
+        if (decoder->decode(pkt->data) && takeFrame(t, opt, &pts_list, frame, pts))
+            return true;
+        // no other frame is decoded. a delayed key frame is drained below
+        if (opt.key_only)
+            break;
+    }
+    if (!started)
+        return false;
+    for (int i = 0; i < kMaxDrain && decoder->decode(QByteArray()); ++i) {
+        if (takeFrame(t, opt, &pts_list, frame, pts))
+            return true;
+    }
+    return false;
+}
+
+bool ExtractWorker::takeFrame(qreal t, const ExtractOptions &opt, QVector<qreal> *pts_list, VideoFrame *frame, qreal *pts)
+{
+    VideoFrame f = decoder->frame();
+    if (!f.isValid() || pts_list->isEmpty())
+        return false;
+    qSort(*pts_list);
+    const qreal frame_pts = pts_list->first();
+    pts_list->remove(0);
+    // the frame displayed at t
+    if (!opt.key_only && frame_pts + frame_duration*0.5 < t)
+        return false;
+    *frame = convert(f, opt);
+    *pts = frame_pts;
+    return frame->isValid();
+}
+
+VideoFrame ExtractWorker::convert(const VideoFrame &frame, const ExtractOptions &opt)
+{
+    if (!conv)
+        conv = ImageConverterFactory::create(ImageConverterId_FF);
+    if (!conv)
+        return VideoFrame();
+    const VideoFormat fmt(opt.format);
+    // pixel format and size are converted in 1 pass
+    conv->setInFormat(frame.pixelFormatFFmpeg());
+    conv->setInSize(frame.width(), frame.height());
+    conv->setInColorSpace(frame.colorSpace());
+    conv->setInRange(frame.colorRange());
+    conv->setOutFormat(fmt.pixelFormatFFmpeg());
+    conv->setOutSize(out_size.width(), out_size.height());
+    const quint8 *planes[4] = { 0, 0, 0, 0 };
+    int strides[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < qMin(frame.planeCount(), 4); ++i) {
+        planes[i] = frame.bits(i);
+        strides[i] = frame.bytesPerLine(i);
+    }
+    if (!conv->convert(planes, strides))
+        return VideoFrame();
+    QVector<quint8*> out_planes = conv->outPlanes();
+    QVector<int> out_line_sizes = conv->outLineSizes();
+    out_planes.resize(fmt.planeCount());
+    out_line_sizes.resize(fmt.planeCount());
+    VideoFrame out(conv->outData(), out_size.width(), out_size.height(), fmt);
+    out.setBits(out_planes);
+    out.setBytesPerLine(out_line_sizes);
+    // converter's buffer is overwritten by the next frame
+    VideoFrame copy = out.clone();
+    if (fmt.isRGB()) {
+        copy.setColorRange(AVCOL_RANGE_JPEG);
+    } else {
+        copy.setColorSpace(frame.colorSpace());
+        copy.setColorRange(frame.colorRange());
+    }
+    return copy;
+}
+
+class FrameExtractorPrivate : public DPtrPrivate<FrameExtractor>
+{
+public:
+    FrameExtractorPrivate()
+        : pending(0)
+        , generation(0)
+    {
+        options.format = VideoFormat::Format_RGB32;
+        options.size = QSize(160, 160);
+        options.key_only = true;
+        options.lowres = true;
+    }
+    ~FrameExtractorPrivate() {
+        qDeleteAll(workers);
+        workers.clear();
+    }
+    ExtractWorker* takeWorker() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        if (!workers.isEmpty())
+            return workers.takeLast();
+        return new ExtractWorker();
+    }
+    void putWorker(ExtractWorker *w) {
+        w->close();
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        workers.append(w);
+    }
+    bool isCanceled(int g) const {
+        return generation.fetchAndAddRelaxed(0) != g;
+    }
+    // count > 0: count evenly spaced key frames instead of positions
+    void extract(const QString& file, const QList<qint64>& positions, int count, int g
+                 , FrameExtractor::ResultCallback callback, void *opaque);
+    void start(const QStringList& files, const QList<qint64>& positions, int count
+               , FrameExtractor::ResultCallback callback, void *opaque);
+
+    ExtractOptions options;
+    QList<ExtractWorker*> workers; //idle workers
+    mutable QMutex mutex; //options, workers, pending
+    QWaitCondition done_cond;
+    int pending;
+    mutable QAtomicInt generation; //increased by cancel()
+};
+
+class ExtractTask : public QRunnable
+{
+public:
+    ExtractTask(FrameExtractorPrivate *d, const QString& f, const QList<qint64>& pos, int n, int g
+                , FrameExtractor::ResultCallback cb, void *op)
+        : priv(d)
+        , file(f)
+        , positions(pos)
+        , count(n)
+        , generation(g)
+        , callback(cb)
+        , opaque(op)
+    {}
+    virtual void run() {
+        if (!priv->isCanceled(generation))
+            priv->extract(file, positions, count, generation, callback, opaque);
+        QMutexLocker lock(&priv->mutex);
+        Q_UNUSED(lock);
+        --priv->pending;
+        priv->done_cond.wakeAll();
+    }
+private:
+    FrameExtractorPrivate *priv;
+    QString file;
+    QList<qint64> positions;
+    int count;
+    int generation;
+    FrameExtractor::ResultCallback callback;
+    void *opaque;
+};
+
+void FrameExtractorPrivate::extract(const QString &file, const QList<qint64> &positions, int count, int g
+                                    , FrameExtractor::ResultCallback callback, void *opaque)
+{
+    ExtractOptions opt;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        opt = options;
+    }
+    ExtractWorker *w = takeWorker();
+    FrameExtractor::Result r;
+    r.file = file;
+    if (!w->open(file, opt)) {
+        putWorker(w);
+        r.last = true;
+        callback(r, opaque);
+        return;
+    }
+    QList<qint64> pos(positions);
+    if (count > 0) {
+        opt.key_only = true;
+        pos.clear();
+        const qint64 start = w->demuxer.startTime();
+        const qint64 duration = qMax<qint64>(0, w->demuxer.duration());
+        // the middle of each part. unknown duration: the first count key frames
+        for (int i = 0; i < count; ++i)
+            pos.append(start + duration*(2*i + 1)/(2*count));
+    }
+    qreal min_pts = -std::numeric_limits<qreal>::max();
+    // a result is reported when the next one is ready, so the last one can be marked
+    bool has_result = false;
+    for (int i = 0; i < pos.size(); ++i) {
+        if (isCanceled(g))
+            break;
+        VideoFrame frame;
+        qreal pts = 0;
+        const bool ok = w->extract(pos.at(i), min_pts, opt, &frame, &pts);
+        // no more key frames after min_pts
+        if (!ok && count > 0)
+            break;
+        if (has_result)
+            callback(r, opaque);
+        r.index = i;
+        r.position = pos.at(i);
+        r.pts = ok ? qint64(pts*1000.0) : 0;
+        r.frame = frame;
+        has_result = true;
+        if (count > 0)
+            min_pts = pts;
+    }
+    putWorker(w);
+    if (!has_result) {
+        r.index = -1;
+        r.frame = VideoFrame();
+    }
+    r.last = true;
+    callback(r, opaque);
+}
+
+void FrameExtractorPrivate::start(const QStringList &files, const QList<qint64> &positions, int count
+                                  , FrameExtractor::ResultCallback callback, void *opaque)
+{
+    if (!callback)
+        return;
+    const int g = generation.fetchAndAddRelaxed(0);
+    foreach (const QString& file, files) {
+        {
+            QMutexLocker lock(&mutex);
+            Q_UNUSED(lock);
+            ++pending;
+        }
+        // a file takes long. the frame conversions waited by players are not blocked
+        WorkerPool::instance().startBackground(new ExtractTask(this, file, positions, count, g, callback, opaque));
+    }
+}
+
+static void appendResult(const FrameExtractor::Result& result, void *opaque)
+{
+    static_cast<QList<FrameExtractor::Result>*>(opaque)->append(result);
+}
+
+QImage FrameExtractor::Result::toImage() const
+{
+    const QImage::Format fmt = frame.imageFormat();
+    if (!frame.isValid() || fmt == QImage::Format_Invalid)
+        return QImage();
+    return QImage(frame.bits(0), frame.width(), frame.height(), frame.bytesPerLine(0), fmt).copy();
+}
+
+FrameExtractor::FrameExtractor()
+{
+}
+
+FrameExtractor::~FrameExtractor()
+{
+    cancel();
+    waitForDone();
+}
+
+void FrameExtractor::setPixelFormat(VideoFormat::PixelFormat format)
+{
+    DPTR_D(FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.options.format = format;
+}
+
+VideoFormat::PixelFormat FrameExtractor::pixelFormat() const
+{
+    DPTR_D(const FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.options.format;
+}
+
+void FrameExtractor::setSize(const QSize &size)
+{
+    DPTR_D(FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.options.size = size;
+}
+
+QSize FrameExtractor::size() const
+{
+    DPTR_D(const FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.options.size;
+}
+
+void FrameExtractor::setKeyFrameOnly(bool k)
+{
+    DPTR_D(FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.options.key_only = k;
+}
+
+bool FrameExtractor::isKeyFrameOnly() const
+{
+    DPTR_D(const FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.options.key_only;
+}
+
+void FrameExtractor::setLowResolution(bool lowres)
+{
+    DPTR_D(FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.options.lowres = lowres;
+}
+
+bool FrameExtractor::isLowResolution() const
+{
+    DPTR_D(const FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.options.lowres;
+}
+
+QList<FrameExtractor::Result> FrameExtractor::extract(const QString &file, const QList<qint64> &positions)
+{
+    DPTR_D(FrameExtractor);
+    QList<Result> results;
+    d.extract(file, positions, 0, d.generation.fetchAndAddRelaxed(0), appendResult, &results);
+    return results;
+}
+
+QList<FrameExtractor::Result> FrameExtractor::extractKeyFrames(const QString &file, int count)
+{
+    DPTR_D(FrameExtractor);
+    QList<Result> results;
+    if (count <= 0)
+        return results;
+    d.extract(file, QList<qint64>(), count, d.generation.fetchAndAddRelaxed(0), appendResult, &results);
+    return results;
+}
+
+void FrameExtractor::extractAsync(const QStringList &files, const QList<qint64> &positions, ResultCallback callback, void *opaque)
+{
+    d_func().start(files, positions, 0, callback, opaque);
+}
+
+void FrameExtractor::extractKeyFramesAsync(const QStringList &files, int count, ResultCallback callback, void *opaque)
+{
+    if (count <= 0)
+        return;
+    d_func().start(files, QList<qint64>(), count, callback, opaque);
+}
+
+void FrameExtractor::cancel()
+{
+    d_func().generation.fetchAndAddRelaxed(1);
+}
+
+void FrameExtractor::waitForDone()
+{
+    DPTR_D(FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    while (d.pending > 0)
+        d.done_cond.wait(&d.mutex);
+}
+
+int FrameExtractor::pending() const
+{
+    DPTR_D(const FrameExtractor);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.pending;
+}
+
+} //namespace QtAV
@@ -58,10 +58,21 @@
 
 #include <QtAV/FilterContext.h>
 #include <QtAV/OSDFilter.h>
+#include <QtAV/QtAV_Compat.h>
 
 #define UPLOAD_ROI 0
 #define ROI_TEXCOORDS 1
 
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif //GL_PIXEL_UNPACK_BUFFER
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif //GL_STREAM_DRAW
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif //GL_WRITE_ONLY
+
 //TODO: QGLfunctions?
 namespace QtAV {
 
@@ -95,15 +106,117 @@ static const char kVertexShader[] =
     "  v_TexCoords = a_TexCoords; \n"
     "}\n";
 
-static const char kFragmentShader[] =
-#ifdef QT_OPENGL_ES_2
-    "precision mediump float;\n"
-#endif
-    "uniform sampler2D u_Texture0;\n"
-    "varying vec2 v_TexCoords;\n"
-    "void main() {\n"
-    "  gl_FragColor = texture2D(u_Texture0, v_TexCoords);\n"
-    "}\n";
+// load from applicationDirPath first, then qrc
+static QByteArray fragmentShader(const QString& name)
+{
+    QString shader_file = "/shaders/" + name;
+    QFile f(qApp->applicationDirPath() + shader_file);
+    if (!f.exists()) {
+        f.setFileName(":" + shader_file);
+    }
+    if (!f.open(QIODevice::ReadOnly)) {
+        qWarning("Can not load shader %s: %s", f.fileName().toUtf8().constData(), f.errorString().toUtf8().constData());
+        return QByteArray();
+    }
+    QByteArray src = f.readAll();
+    f.close();
+    return src;
+}
+
+// row major 4x4 matrices. out = a*b
+static void mat4Mul(const GLfloat *a, const GLfloat *b, GLfloat *out)
+{
+    GLfloat m[16];
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            m[r*4+c] = a[r*4]*b[c] + a[r*4+1]*b[4+c] + a[r*4+2]*b[8+c] + a[r*4+3]*b[12+c];
+        }
+    }
+    memcpy(out, m, sizeof(m));
+}
+
+// luma coefficients of AVColorSpace. unspecified: HD is usually bt709
+static void lumaCoefficients(int cs, int height, GLfloat *kr, GLfloat *kb)
+{
+    switch (cs) {
+    case AVCOL_SPC_BT709:
+        *kr = 0.2126f; *kb = 0.0722f;
+        break;
+    case AVCOL_SPC_FCC:
+        *kr = 0.30f; *kb = 0.11f;
+        break;
+    case AVCOL_SPC_SMPTE240M:
+        *kr = 0.212f; *kb = 0.087f;
+        break;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+        *kr = 0.299f; *kb = 0.114f;
+        break;
+    default:
+        if (height >= 720) {
+            *kr = 0.2126f; *kb = 0.0722f;
+        } else {
+            *kr = 0.299f; *kb = 0.114f;
+        }
+        break;
+    }
+}
+
+// normalized yuv(y: 0~1, uv: -0.5~0.5) => rgb
+static void yuvToRgb(GLfloat kr, GLfloat kb, GLfloat *m)
+{
+    const GLfloat kg = 1.0f - kr - kb;
+    const GLfloat t[] = {
+        1, 0,                       2.0f*(1.0f-kr),           0,
+        1, -2.0f*kb*(1.0f-kb)/kg,   -2.0f*kr*(1.0f-kr)/kg,    0,
+        1, 2.0f*(1.0f-kb),          0,                        0,
+        0, 0,                       0,                        1
+    };
+    memcpy(m, t, sizeof(t));
+}
+
+static void rgbToYuv(GLfloat kr, GLfloat kb, GLfloat *m)
+{
+    const GLfloat kg = 1.0f - kr - kb;
+    const GLfloat t[] = {
+        kr,                         kg,                         kb,                         0,
+        -kr/(2.0f*(1.0f-kb)),       -kg/(2.0f*(1.0f-kb)),       0.5f,                       0,
+        0.5f,                       -kg/(2.0f*(1.0f-kr)),       -kb/(2.0f*(1.0f-kr)),       0,
+        0,                          0,                          0,                          1
+    };
+    memcpy(m, t, sizeof(t));
+}
+
+// texture values => normalized yuv
+static void yuvRange(bool full, GLfloat *m)
+{
+    const GLfloat ys = full ? 1.0f : 255.0f/219.0f;
+    const GLfloat yo = full ? 0.0f : -16.0f/219.0f;
+    const GLfloat cs = full ? 1.0f : 255.0f/224.0f;
+    const GLfloat co = -128.0f/255.0f*cs;
+    const GLfloat t[] = {
+        ys, 0,  0,  yo,
+        0,  cs, 0,  co,
+        0,  0,  cs, co,
+        0,  0,  0,  1
+    };
+    memcpy(m, t, sizeof(t));
+}
+
+// brightness, contrast, saturation: -100~100, in normalized yuv
+static void yuvEQ(int brightness, int contrast, int saturation, GLfloat *m)
+{
+    const GLfloat b = (GLfloat)brightness/100.0f;
+    const GLfloat c = (GLfloat)(contrast + 100)/100.0f;
+    const GLfloat s = (GLfloat)(saturation + 100)/100.0f;
+    const GLfloat t[] = {
+        c, 0,   0,   b,
+        0, c*s, 0,   0,
+        0, 0,   c*s, 0,
+        0, 0,   0,   1
+    };
+    memcpy(m, t, sizeof(t));
+}
 
 
 //http://www.opengl.org/wiki/GLSL#Error_Checking
@@ -182,26 +295,41 @@ GLuint GLWidgetRendererPrivate::createProgram(const char* pVertexSource, const c
     return program;
 }
 
-bool GLWidgetRendererPrivate::releaseResource()
+bool GLWidgetRendererPrivate::releaseTextures()
 {
     pixel_fmt = VideoFormat::Format_Invalid;
     texture0Size = QSize();
     glDeleteTextures(textures.size(), textures.data());
     qDebug("delete %d textures", textures.size());
     textures.clear();
+    for (int i = 0; i < 2; ++i) {
+        if (!pbo[i].isEmpty()) {
+            glDeleteBuffers(pbo[i].size(), pbo[i].data());
+            pbo[i].clear();
+        }
+    }
+    // new textures are empty
+    frame_changed = true;
+    return true;
+}
+
+bool GLWidgetRendererPrivate::releaseResource()
+{
+    releaseTextures();
+    // program is one of the cached programs
+    program = 0;
+    foreach (const ShaderProgram& sp, programs) {
+        glDeleteProgram(sp.program);
+    }
+    programs.clear();
+    // shaders of a program failed to be cached
     if (vert) {
-        if (program)
-            glDetachShader(program, vert);
         glDeleteShader(vert);
+        vert = 0;
     }
     if (frag) {
-        if (program)
-            glDetachShader(program, frag);
         glDeleteShader(frag);
-    }
-    if (program) {
-        glDeleteProgram(program);
-        program = 0;
+        frag = 0;
     }
     return true;
 }
@@ -226,18 +354,111 @@ bool GLWidgetRendererPrivate::initTexture(GLuint tex, GLint internalFormat, GLen
     return true;
 }
 
+static GLenum texelFormat(int bytes)
+{
+    switch (bytes) {
+    case 1:
+        return GL_LUMINANCE; //vec4(L,L,L,1)
+    case 2:
+        return GL_LUMINANCE_ALPHA; //vec4(L,L,L,A)
+    case 4:
+        return GL_RGBA;
+    default:
+        return 0;
+    }
+}
+
+// channel of the byte at offset in a texel
+static char texelChannel(int bytes, int offset)
+{
+    if (bytes == 2)
+        return offset == 0 ? 'r' : 'a';
+    return "rgba"[offset];
+}
+
+// glsl expression of component c, normalized to 0~1
+static QByteArray sampleComponent(const AVPixFmtDescriptor *desc, int c, int tex, int texelBytes)
+{
+    const AVComponentDescriptor &comp = desc->comp[c];
+    const int depth = comp.depth_minus1 + 1;
+    // for packed formats, a chroma texel contains 2 pixels
+    const int offset = (comp.offset_plus1 - 1) % texelBytes;
+    const QByteArray t = "texture2D(u_Texture" + QByteArray::number(tex) + ", v_TexCoords).";
+    if (depth <= 8)
+        return "(" + t + texelChannel(texelBytes, offset) + ")";
+    int lo = offset, hi = offset + 1;
+    if (desc->flags & AV_PIX_FMT_FLAG_BE)
+        qSwap(lo, hi);
+    // (low + high*256)*255/max. values are small enough for mediump
+    const double scale = 255.0/(double)(((1 << depth) - 1) << comp.shift);
+    return "(dot(" + t + texelChannel(texelBytes, lo) + texelChannel(texelBytes, hi)
+            + ", vec2(1.0, 256.0))*" + QByteArray::number(scale, 'g', 9) + ")";
+}
+
+bool GLWidgetRendererPrivate::setupYUVTextures(const VideoFormat &fmt, int width, int height, QByteArray *defines)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)fmt.pixelFormatFFmpeg());
+    if (!desc || desc->nb_components < 3)
+        return false;
+    if (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_HWACCEL))
+        return false;
+    texture_plane.clear();
+    texture_size.clear();
+    texel_bytes.clear();
+    int comp_tex[3];
+    if (desc->flags & AV_PIX_FMT_FLAG_PLANAR) {
+        // yuv420p, yuv422p, nv12 etc. 1 texture for each plane, a texel is a pixel of the plane
+        for (int c = 0; c < 3; ++c) {
+            const AVComponentDescriptor &comp = desc->comp[c];
+            int t = texture_plane.indexOf(comp.plane);
+            if (t < 0) {
+                t = texture_plane.size();
+                texture_plane.append(comp.plane);
+                texel_bytes.append(comp.step_minus1 + 1);
+                if (comp.plane == desc->comp[0].plane)
+                    texture_size.append(QSize(width, height));
+                else
+                    texture_size.append(QSize(fmt.chromaWidth(width), fmt.chromaHeight(height)));
+            }
+            comp_tex[c] = t;
+        }
+    } else {
+        // packed 4:2:2, e.g. yuyv, uyvy. 2 textures for the plane. luma texel is 1 pixel, chroma texel is 2 pixels
+        if (desc->log2_chroma_w != 1 || desc->log2_chroma_h != 0 || desc->comp[0].depth_minus1 >= 8)
+            return false;
+        texture_plane << 0 << 0;
+        texel_bytes << desc->comp[0].step_minus1 + 1 << desc->comp[1].step_minus1 + 1;
+        texture_size << QSize(width, height) << QSize(fmt.chromaWidth(width), height);
+        comp_tex[0] = 0;
+        comp_tex[1] = comp_tex[2] = 1;
+    }
+    internal_format.clear();
+    data_format.clear();
+    for (int t = 0; t < texel_bytes.size(); ++t) {
+        const GLenum f = texelFormat(texel_bytes[t]);
+        if (!f)
+            return false;
+        internal_format.append(f);
+        data_format.append(f);
+    }
+    static const char *kSample[] = { "SAMPLE_Y", "SAMPLE_U", "SAMPLE_V" };
+    defines->clear();
+    for (int c = 0; c < 3; ++c) {
+        *defines += QByteArray("#define ") + kSample[c] + " "
+                + sampleComponent(desc, c, comp_tex[c], texel_bytes[comp_tex[c]]) + "\n";
+    }
+    return true;
+}
+
 bool GLWidgetRendererPrivate::prepareShaderProgram(const VideoFormat &fmt, int width, int height)
 {
     // isSupported(pixfmt)
     if (!fmt.isValid())
         return false;
-    releaseResource();
+    releaseTextures();
     pixel_fmt = fmt.pixelFormat();
     texture0Size = QSize(width, height);
 
-    textures.resize(fmt.planeCount());
-    glGenTextures(textures.size(), textures.data());
-
     //http://www.berkelium.com/OpenGL/GDC99/internalformat.html
     //TODO: check channels
     //NV12: UV is 1 plane. 16 bits as a unit. GL_LUMINANCE4, 8, 16, ... 32?
@@ -252,80 +473,212 @@ bool GLWidgetRendererPrivate::prepareShaderProgram(const VideoFormat &fmt, int w
      * GL ES2 support: GL_RGB, GL_RGBA, GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_ALPHA
      * http://stackoverflow.com/questions/18688057/which-opengl-es-2-0-texture-formats-are-color-depth-or-stencil-renderable
      */
-    internal_format = QVector<GLint>(fmt.planeCount(), FMT_INTERNAL);
-    data_format = QVector<GLenum>(fmt.planeCount(), FMT);
+    QByteArray defines;
     if (fmt.isRGB()) {
-        if (fmt.isPlanar()) {
-
-        }
-    } else {
-        //uyvy, nv12, yv12
-        if (fmt.isPlanar()) {
-            //why luminance?
-            internal_format[0] = internal_format[1] = GL_LUMINANCE; //vec4(L,L,L,0)
-            data_format[0] = data_format[1] = GL_LUMINANCE; //or GL_RED
-            internal_format[2] = GL_ALPHA;
-            data_format[2] = GL_ALPHA;
-            //channels == 2: GL_RG, GL_LUMINANCE_ALPHA
-        } else {
-            //check channles
-        }
+        texture_plane = QVector<int>(1, 0);
+        texture_size = QVector<QSize>(1, QSize(width, height));
+        texel_bytes = QVector<int>(1, fmt.bytesPerPixel(0));
+        internal_format = QVector<GLint>(1, FMT_INTERNAL);
+        data_format = QVector<GLenum>(1, FMT);
+    } else if (!hasGLSL || !setupYUVTextures(fmt, width, height, &defines)) {
+        qWarning("Unsupported pixel format: %s", fmt.name().toUtf8().constData());
+        return false;
+    }
+    textures.resize(texture_plane.size());
+    glGenTextures(textures.size(), textures.data());
+    for (int i = 0; i < textures.size(); ++i) {
+        initTexture(textures[i], internal_format[i], data_format[i], texture_size[i].width(), texture_size[i].height());
     }
-
     if (!hasGLSL) {
-        // more than 1?
-        initTexture(textures[0], internal_format[0], data_format[0], width, height);
         qWarning("Does not support GLSL!");
         return false;
     }
-    // FIXME
-    if (fmt.isRGB()) {
-        program = createProgram(kVertexShader, kFragmentShader);
+    if (!programs.contains(fmt.pixelFormatFFmpeg())) {
+        // FIXME
+        QByteArray frag_src = fragmentShader(fmt.isRGB() ? "rgb.f.glsl" : "yuv_rgb.f.glsl");
+        if (frag_src.isEmpty())
+            return false;
+        program = createProgram(kVertexShader, (defines + frag_src).constData());
         if (!program) {
             qWarning("Could not create shader program.");
             return false;
         }
-    } else if (fmt == VideoFormat::Format_YUV420P) {
-        QString shader_file = "/shaders/yuv_rgb.f.glsl";
-        QFile f(qApp->applicationDirPath() + shader_file);
-        if (!f.exists()) {
-            f.setFileName(":" + shader_file);
-        }
-        if (!f.open(QIODevice::ReadOnly)) {
-            qWarning("Can not load shader %s: %s", f.fileName().toUtf8().constData(), f.errorString().toUtf8().constData());
-            return false;
+        // shaders are detached. the cached program is enough
+        glDeleteShader(vert);
+        glDeleteShader(frag);
+        vert = frag = 0;
+        ShaderProgram sp;
+        sp.program = program;
+        // vertex shader
+        CHECK_GL_ERROR(sp.a_Position = glGetAttribLocation(program, "a_Position"));
+        sp.a_TexCoords = glGetAttribLocation(program, "a_TexCoords");
+        qDebug("glGetAttribLocation(\"a_TexCoords\") = %d\n", sp.a_TexCoords);
+        sp.u_matrix = glGetUniformLocation(program, "u_MVP_matrix");
+        qDebug("glGetUniformLocation(\"u_MVP_matrix\") = %d\n", sp.u_matrix);
+        sp.u_colorMatrix = glGetUniformLocation(program, "u_colorMatrix");
+        // fragment shader
+        sp.u_Texture.resize(textures.size());
+        for (int i = 0; i < textures.size(); ++i) {
+            QString tex_var = QString("u_Texture%1").arg(i);
+            sp.u_Texture[i] = glGetUniformLocation(program, tex_var.toUtf8().constData());
+            qDebug("glGetUniformLocation(\"%s\") = %d\n", tex_var.toUtf8().constData(), sp.u_Texture[i]);
         }
-        program = createProgram(kVertexShader, f.readAll().constData());
-        f.close();
-        if (!program) {
-            qWarning("Could not create shader program.");
-            return false;
+        programs.insert(fmt.pixelFormatFFmpeg(), sp);
+        qDebug("shader program for %s created. cached programs: %d", fmt.name().toUtf8().constData(), programs.size());
+    }
+    const ShaderProgram &sp = programs[fmt.pixelFormatFFmpeg()];
+    program = sp.program;
+    a_Position = sp.a_Position;
+    a_TexCoords = sp.a_TexCoords;
+    u_matrix = sp.u_matrix;
+    u_colorMatrix = sp.u_colorMatrix;
+    u_Texture = sp.u_Texture;
+    // program changed. uniforms must be set again
+    update_color_matrix = true;
+    if (pbo_supported) {
+        for (int i = 0; i < 2; ++i) {
+            pbo[i].resize(textures.size());
+            glGenBuffers(pbo[i].size(), pbo[i].data());
         }
-    } else {
+        pbo_index = 0;
+    }
+    frame_changed = true;
+    return true;
+}
+
+bool GLWidgetRendererPrivate::initPBO(const QGLContext *ctx)
+{
+    pbo_supported = false;
+#ifndef QT_OPENGL_ES_2
+    if (qgetenv("QTAV_GL_NO_PBO").toInt() > 0) {
+        qDebug("pbo is disabled by QTAV_GL_NO_PBO");
+        return false;
+    }
+    const QByteArray extensions(reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS)));
+    if (!(QGLFormat::openGLVersionFlags() & QGLFormat::OpenGL_Version_2_1)
+            && !extensions.contains("GL_ARB_pixel_buffer_object")
+            && !extensions.contains("GL_EXT_pixel_buffer_object")) {
+        qDebug("pixel buffer object is not supported");
+        return false;
+    }
+    // software rasterizers read the buffer on the cpu. the extra copy is slower than glTexSubImage2D
+    const QByteArray renderer(reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+    if (renderer.contains("llvmpipe") || renderer.contains("softpipe") || renderer.contains("Software Rasterizer")
+            || renderer.contains("GDI Generic")) {
+        qDebug("pbo is disabled for software renderer %s", renderer.constData());
         return false;
     }
-    // vertex shader
-    CHECK_GL_ERROR(a_Position = glGetAttribLocation(program, "a_Position"));
-    a_TexCoords = glGetAttribLocation(program, "a_TexCoords");
-    qDebug("glGetAttribLocation(\"a_TexCoords\") = %d\n", a_TexCoords);
-    u_matrix = glGetUniformLocation(program, "u_MVP_matrix");
-    qDebug("glGetUniformLocation(\"u_MVP_matrix\") = %d\n", u_matrix);
+    glMapBuffer = (MapBuffer_t)ctx->getProcAddress("glMapBuffer");
+    if (!glMapBuffer)
+        glMapBuffer = (MapBuffer_t)ctx->getProcAddress("glMapBufferARB");
+    glUnmapBuffer = (UnmapBuffer_t)ctx->getProcAddress("glUnmapBuffer");
+    if (!glUnmapBuffer)
+        glUnmapBuffer = (UnmapBuffer_t)ctx->getProcAddress("glUnmapBufferARB");
+    pbo_supported = glMapBuffer && glUnmapBuffer;
+#else
+    Q_UNUSED(ctx);
+#endif //QT_OPENGL_ES_2
+    qDebug("pixel buffer object: %d", pbo_supported);
+    return pbo_supported;
+}
 
-    // fragment shader
-    u_Texture.resize(fmt.planeCount());
-    for (int i = 0; i < textures.size(); ++i) {
-        QString tex_var = QString("u_Texture%1").arg(i);
-        u_Texture[i] = glGetUniformLocation(program, tex_var.toUtf8().constData());
-        qDebug("glGetUniformLocation(\"%s\") = %d\n", tex_var.toUtf8().constData(), u_Texture[i]);
-        if (i == 0) {
-            width = fmt.chromaWidth(width);
-            height = fmt.chromaHeight(height);
+bool GLWidgetRendererPrivate::fillPBO(int tex)
+{
+    if (tex >= pbo[pbo_index].size())
+        return false;
+    const int p = texture_plane[tex];
+    const int w = texture_size[tex].width();
+    const int h = texture_size[tex].height();
+    const int bpl_src = video_frame.bytesPerLine(p);
+    const int bpl = w*texel_bytes[tex];
+    // rows are packed with the default GL_UNPACK_ALIGNMENT 4
+    const int bpl_dst = (bpl + 3) & ~3;
+    const int bytes = bpl_dst*h;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[pbo_index][tex]);
+    // orphan the old storage, so the driver does not wait for a pending transfer
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    uchar *dst = (uchar*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!dst) {
+        qWarning("map pixel buffer object failed. use synchronous upload");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pbo_supported = false;
+        return false;
+    }
+    const uchar *src = video_frame.bits(p);
+    if (bpl_src == bpl_dst) {
+        memcpy(dst, src, bytes);
+    } else {
+        for (int y = 0; y < h; ++y) {
+            memcpy(dst, src, qMin(bpl, bpl_src));
+            src += bpl_src;
+            dst += bpl_dst;
         }
-        initTexture(textures[i], internal_format[i], data_format[i], width, height);
     }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     return true;
 }
 
+void GLWidgetRendererPrivate::uploadPlanePBO(int tex, GLenum format)
+{
+    if (hasGLSL) {
+        glActiveTexture(GL_TEXTURE0 + tex);
+    }
+    glBindTexture(GL_TEXTURE_2D, textures[tex]);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[pbo_index][tex]);
+    // returns immediately. data is transfered from pbo asynchronously
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture_size[tex].width(), texture_size[tex].height(), format, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GLWidgetRendererPrivate::setupColorMatrix()
+{
+    if (!hasGLSL)
+        return;
+    if (!update_color_matrix
+            && color_key.cs == video_frame.colorSpace()
+            && color_key.range == video_frame.colorRange()
+            && color_key.height == video_frame.height()
+            && color_key.brightness == brightness
+            && color_key.contrast == contrast
+            && color_key.saturation == saturation)
+        return;
+    color_key.cs = video_frame.colorSpace();
+    color_key.range = video_frame.colorRange();
+    color_key.height = video_frame.height();
+    color_key.brightness = brightness;
+    color_key.contrast = contrast;
+    color_key.saturation = saturation;
+    update_color_matrix = false;
+
+    const bool rgb = video_frame.format().isRGB();
+    GLfloat kr = 0, kb = 0;
+    GLfloat m[16], t[16];
+    yuvEQ(brightness, contrast, saturation, m);
+    if (rgb) {
+        // eq in yuv space
+        lumaCoefficients(AVCOL_SPC_BT470BG, 0, &kr, &kb);
+        rgbToYuv(kr, kb, t);
+        mat4Mul(m, t, m);
+        yuvToRgb(kr, kb, t);
+        mat4Mul(t, m, m);
+    } else {
+        lumaCoefficients(color_key.cs, color_key.height, &kr, &kb);
+        yuvRange(color_key.range == AVCOL_RANGE_JPEG, t);
+        mat4Mul(m, t, m);
+        yuvToRgb(kr, kb, t);
+        mat4Mul(t, m, m);
+    }
+    // GLSL is column major, and ES2 does not support transpose
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            t[c*4+r] = m[r*4+c];
+        }
+    }
+    glUniformMatrix4fv(u_colorMatrix, 1, GL_FALSE, t);
+}
+
 void GLWidgetRendererPrivate::upload(const QRect &roi)
 {
     const VideoFormat fmt = video_frame.format();
@@ -344,18 +697,41 @@ void GLWidgetRendererPrivate::upload(const QRect &roi)
             qDebug("shader program created!!!");
         }
     }
-    //glPixelStorei(GL_UNPACK_ALIGNMENT,1); //xbmc: nv12 use bpp
-    for (int i = 0; i < video_frame.planeCount(); ++i) {
-        uploadPlane(i, internal_format[i], data_format[i], roi);
+    const bool changed = frame_changed;
+    frame_changed = false;
+    if (!pbo_supported || !(ROI_TEXCOORDS || roi.size() == video_frame.size())) {
+        //glPixelStorei(GL_UNPACK_ALIGNMENT,1); //xbmc: nv12 use bpp
+        for (int i = 0; i < textures.size(); ++i) {
+            uploadPlane(i, internal_format[i], data_format[i], roi);
+        }
+        return;
     }
+    // the textures already have the frame
+    if (!changed)
+        return;
+    for (int i = 0; i < textures.size(); ++i) {
+        if (!fillPBO(i)) {
+            // mapping failed. pbo is disabled
+            for (int j = 0; j < textures.size(); ++j) {
+                uploadPlane(j, internal_format[j], data_format[j], roi);
+            }
+            return;
+        }
+    }
+    for (int i = 0; i < textures.size(); ++i) {
+        uploadPlanePBO(i, data_format[i]);
+    }
+    // the next frame is copied to the other pbo, so mapping does not wait for this transfer
+    pbo_index = (pbo_index + 1) % 2;
 }
 
-void GLWidgetRendererPrivate::uploadPlane(int p, GLint internalFormat, GLenum format, const QRect& roi)
+void GLWidgetRendererPrivate::uploadPlane(int tex, GLint internalFormat, GLenum format, const QRect& roi)
 {
     if (hasGLSL) {
-        glActiveTexture(GL_TEXTURE0 + p); //TODO: can remove??
+        glActiveTexture(GL_TEXTURE0 + tex); //TODO: can remove??
     }
-    glBindTexture(GL_TEXTURE_2D, textures[p]);
+    glBindTexture(GL_TEXTURE_2D, textures[tex]);
+    const int p = texture_plane[tex];
     setupQuality();
     //qDebug("bpl[%d]=%d", p, video_frame.bytesPerLine(p));
     // This is necessary for non-power-of-two textures
@@ -366,15 +742,23 @@ void GLWidgetRendererPrivate::uploadPlane(int p, GLint internalFormat, GLenum fo
     //FIXME: more cpu usage then qpainter. FBO, VBO?
     //roi for planes?
     if (ROI_TEXCOORDS || roi.size() == video_frame.size()) {
+#ifdef GL_UNPACK_ROW_LENGTH
+        // stride may be larger than the texture width. not available in ES2
+        if (video_frame.bytesPerLine(p) % texel_bytes[tex] == 0)
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, video_frame.bytesPerLine(p)/texel_bytes[tex]);
+#endif //GL_UNPACK_ROW_LENGTH
         glTexSubImage2D(GL_TEXTURE_2D
                      , 0                //level
                      , 0                // xoffset
                      , 0                // yoffset
-                     , video_frame.planeWidth(p)
-                     , video_frame.planeHeight(p)
+                     , texture_size[tex].width()
+                     , texture_size[tex].height()
                      , format          //format, must the same as internal format?
                      , GL_UNSIGNED_BYTE
                      , video_frame.bits(p));
+#ifdef GL_UNPACK_ROW_LENGTH
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif //GL_UNPACK_ROW_LENGTH
     } else {
         int roi_x = roi.x();
         int roi_y = roi.y();
@@ -463,11 +847,58 @@ bool GLWidgetRenderer::receiveFrame(const VideoFrame& frame)
     QMutexLocker locker(&d.img_mutex);
     Q_UNUSED(locker);
     d.video_frame = frame;
+    d.frame_changed = true;
 
     update(); //can not call updateGL() directly because no event and paintGL() will in video thread
     return true;
 }
 
+VideoFormat::PixelFormat GLWidgetRenderer::preferredPixelFormat() const
+{
+    // yuv => rgb in shader
+    if (d_func().hasGLSL)
+        return VideoFormat::Format_YUV420P;
+    return VideoFormat::Format_RGB32;
+}
+
+bool GLWidgetRenderer::isSupported(VideoFormat::PixelFormat pixfmt) const
+{
+    if (pixfmt == VideoFormat::Format_RGB32)
+        return true;
+    if (!d_func().hasGLSL)
+        return false;
+    switch (pixfmt) {
+    case VideoFormat::Format_YUV420P:
+    case VideoFormat::Format_YV12:
+    case VideoFormat::Format_YUV422P:
+    case VideoFormat::Format_YUV444:
+    case VideoFormat::Format_NV12:
+    case VideoFormat::Format_NV21:
+    case VideoFormat::Format_YUYV:
+    case VideoFormat::Format_UYVY:
+    case VideoFormat::Format_YUV420P10LE:
+    case VideoFormat::Format_YUV420P10BE:
+    case VideoFormat::Format_YUV422P10LE:
+    case VideoFormat::Format_YUV422P10BE:
+    case VideoFormat::Format_YUV444P10LE:
+    case VideoFormat::Format_YUV444P10BE:
+    case VideoFormat::Format_YUV420P16LE:
+    case VideoFormat::Format_YUV420P16BE:
+    case VideoFormat::Format_YUV422P16LE:
+    case VideoFormat::Format_YUV422P16BE:
+    case VideoFormat::Format_YUV444P16LE:
+    case VideoFormat::Format_YUV444P16BE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool GLWidgetRenderer::isEQSupported() const
+{
+    return d_func().hasGLSL;
+}
+
 bool GLWidgetRenderer::needUpdateBackground() const
 {
     return true;
@@ -488,6 +919,7 @@ void GLWidgetRenderer::drawFrame()
     // shader program may not ready before upload
     if (d.hasGLSL) {
         glUseProgram(d.program); //qpainter need
+        d.setupColorMatrix();
     }
     glDisable(GL_DEPTH_TEST);
     for (int i = 0; i < d.textures.size(); ++i) {
@@ -567,6 +999,7 @@ void GLWidgetRenderer::initializeGL()
     qDebug("OpenGL version: %d.%d  hasGLSL: %d", format().majorVersion(), format().minorVersion(), d.hasGLSL);
     initializeGLFunctions();
     d.initializeGLFunctions();
+    d.initPBO(context());
 
     glEnable(GL_TEXTURE_2D);
 #ifndef QT_OPENGL_ES_2
@@ -0,0 +1,335 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/GOPCache.h"
+#include <limits>
+#include <QtCore/QRunnable>
+#include <QtCore/QtAlgorithms>
+#include "QtAV/Packet.h"
+#include "QtAV/VideoDecoder.h"
+#include "QtAV/VideoDecoderTypes.h"
+#include "QtAV/WorkerPool.h"
+#include "QtAV/QtAV_Compat.h"
+
+namespace QtAV {
+
+static const qint64 kDefaultBudget = 256LL*1024LL*1024LL;
+// consecutive reads without a packet
+static const int kMaxSkippedReads = 512;
+// delayed frames in decoder
+static const int kMaxDrain = 64;
+
+class GOPCache::PrefetchTask : public QRunnable
+{
+public:
+    PrefetchTask(GOPCache *c, qreal t) : cache(c), pts(t) {}
+    virtual void run() {
+        cache->load(pts);
+        QMutexLocker lock(&cache->mutex);
+        Q_UNUSED(lock);
+        --cache->prefetching;
+        cache->prefetch_cond.wakeAll();
+    }
+private:
+    GOPCache *cache;
+    qreal pts;
+};
+
+GOPCache::GOPCache()
+    : budget(kDefaultBudget)
+    , usage(0)
+    , decoder(0)
+    , head(-1)
+    , tick(0.001)
+    , prefetching(0)
+{
+}
+
+GOPCache::~GOPCache()
+{
+    close();
+}
+
+bool GOPCache::open(const QString &fileName)
+{
+    close();
+    QMutexLocker lock(&decode_mutex);
+    Q_UNUSED(lock);
+    if (!demuxer.loadFile(fileName)) {
+        qWarning("GOPCache: can not load %s", qPrintable(fileName));
+        return false;
+    }
+    AVCodecContext *ctx = demuxer.videoCodecContext();
+    if (!ctx) {
+        qWarning("GOPCache: no video stream");
+        demuxer.close();
+        return false;
+    }
+    // frames are cloned from decoder's buffer. hw decoders output surfaces
+    decoder = VideoDecoderFactory::create(VideoDecoderId_FFmpeg);
+    if (!decoder) {
+        demuxer.close();
+        return false;
+    }
+    // seekToKeyFrame() uses ms
+    tick = qMax<qreal>(0.001, av_q2d(demuxer.formatContext()->streams[demuxer.videoStream()]->time_base));
+    decoder->setCodecContext(ctx);
+    if (!decoder->prepare() || !decoder->open()) {
+        qWarning("GOPCache: can not open video decoder");
+        delete decoder;
+        decoder = 0;
+        demuxer.close();
+        return false;
+    }
+    return true;
+}
+
+void GOPCache::close()
+{
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        while (prefetching > 0)
+            prefetch_cond.wait(&mutex);
+        gops.clear();
+        usage = 0;
+        head = -1;
+    }
+    QMutexLocker lock(&decode_mutex);
+    Q_UNUSED(lock);
+    if (decoder) {
+        decoder->close();
+        delete decoder;
+        decoder = 0;
+    }
+    demuxer.close();
+}
+
+bool GOPCache::isOpen() const
+{
+    return !!decoder;
+}
+
+void GOPCache::setMemoryBudget(qint64 bytes)
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    budget = bytes;
+}
+
+qint64 GOPCache::memoryBudget() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return budget;
+}
+
+qint64 GOPCache::memoryUsage() const
+{
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    return usage;
+}
+
+VideoFrame GOPCache::frameBefore(qreal pts, qreal *framePts)
+{
+    if (!isOpen())
+        return VideoFrame();
+    // the caller passes the pts of the current frame. do not return it again
+    const qreal t = pts - 0.0001;
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    GOPMap::const_iterator it = findGOP(t);
+    if (it == gops.constEnd()) {
+        lock.unlock();
+        if (!load(t))
+            return VideoFrame();
+        lock.relock();
+        it = findGOP(t);
+    }
+    if (it == gops.constEnd()) {
+        // sparse index. the decoded GOP ends before t. use the nearest frame we have
+        qreal best = -std::numeric_limits<qreal>::max();
+        for (GOPMap::const_iterator i = gops.constBegin(); i != gops.constEnd(); ++i) {
+            if (!i.value().pts.isEmpty() && i.value().pts.first() < t && i.value().pts.last() > best) {
+                best = i.value().pts.last();
+                it = i;
+            }
+        }
+        if (it == gops.constEnd())
+            return VideoFrame();
+    }
+    const GOP &g = it.value();
+    int i = g.pts.size() - 1;
+    while (i > 0 && g.pts.at(i) >= t)
+        --i;
+    if (framePts)
+        *framePts = g.pts.at(i);
+    VideoFrame frame(g.frames.at(i));
+    // the previous GOP is needed soon. 1 tick before the key frame, otherwise the seek finds the key frame itself
+    if (g.start > head)
+        prefetch(g.start - tick);
+    return frame;
+}
+
+GOPCache::GOPMap::const_iterator GOPCache::findGOP(qreal pts) const
+{
+    for (GOPMap::const_iterator it = gops.constBegin(); it != gops.constEnd(); ++it) {
+        const GOP &g = it.value();
+        if (!g.pts.isEmpty() && g.pts.first() < pts && pts <= g.end)
+            return it;
+    }
+    return gops.constEnd();
+}
+
+bool GOPCache::load(qreal pts)
+{
+    QMutexLocker decode_lock(&decode_mutex);
+    Q_UNUSED(decode_lock);
+    if (!decoder)
+        return false;
+    {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        // decoded by prefetch task
+        if (findGOP(pts) != gops.constEnd())
+            return true;
+    }
+    GOP g;
+    if (!decodeGOP(pts, &g))
+        return false;
+    QMutexLocker lock(&mutex);
+    Q_UNUSED(lock);
+    // the seek found no key frame before pts
+    if (g.start > pts)
+        head = g.start;
+    if (!gops.contains(g.start)) {
+        gops.insert(g.start, g);
+        usage += g.bytes;
+    }
+    evict(pts);
+    return true;
+}
+
+void GOPCache::prefetch(qreal pts)
+{
+    if (prefetching > 0 || findGOP(pts) != gops.constEnd())
+        return;
+    ++prefetching;
+    // the frame conversions waited by players are not blocked. needed before thumbnails
+    WorkerPool::instance().startBackground(new PrefetchTask(this, pts), 1);
+}
+
+void GOPCache::evict(qreal pts)
+{
+    while (usage > budget && gops.size() > 1) {
+        GOPMap::iterator farthest = gops.begin();
+        qreal d = -1;
+        for (GOPMap::iterator it = gops.begin(); it != gops.end(); ++it) {
+            const qreal dd = qAbs(it.value().start - pts);
+            if (dd > d) {
+                d = dd;
+                farthest = it;
+            }
+        }
+        usage -= farthest.value().bytes;
+        gops.erase(farthest);
+    }
+}
+
+bool GOPCache::decodeGOP(qreal pts, GOP *gop)
+{
+    if (!demuxer.seekToKeyFrame(qint64(pts*1000.0)))
+        return false;
+    decoder->flush();
+    const int video_stream = demuxer.videoStream();
+    QVector<qreal> pts_list;
+    QList<VideoFrame> frames;
+    qint64 bytes = 0;
+    qint64 max_bytes = memoryBudget();
+    bool started = false;
+    int skipped = 0;
+    gop->end = std::numeric_limits<qreal>::max();
+    forever {
+        if (!demuxer.readFrame()) {
+            if (demuxer.atEnd() || ++skipped > kMaxSkippedReads)
+                break;
+            continue;
+        }
+        skipped = 0;
+        const Packet *pkt = demuxer.packet();
+        if (pkt->isEnd())
+            break;
+        if (demuxer.stream() != video_stream)
+            continue;
+        if (!started) {
+            if (!pkt->hasKeyFrame)
+                continue;
+            started = true;
+            gop->start = pkt->pts;
+        } else if (pkt->hasKeyFrame) {
+            gop->end = pkt->pts;
+            break;
+        }
+        pts_list.append(pkt->pts);
+        if (!decoder->decode(pkt->data))
+            continue;
+        VideoFrame frame = decoder->frame();
+        if (!frame.isValid())
+            continue;
+        VideoFrame copy = frame.clone();
+        copy.setColorSpace(frame.colorSpace());
+        copy.setColorRange(frame.colorRange());
+        frames.append(copy);
+        bytes += copy.frameData().size();
+        // a stream with very few key frames. keep the budget
+        if (bytes > max_bytes) {
+            gop->end = pkt->pts;
+            break;
+        }
+    }
+    for (int i = 0; i < kMaxDrain && decoder->decode(QByteArray()); ++i) {
+        VideoFrame frame = decoder->frame();
+        if (!frame.isValid())
+            break;
+        VideoFrame copy = frame.clone();
+        copy.setColorSpace(frame.colorSpace());
+        copy.setColorRange(frame.colorRange());
+        frames.append(copy);
+        bytes += copy.frameData().size();
+    }
+    if (frames.isEmpty()) {
+        qWarning("GOPCache: no frame decoded near %f", pts);
+        return false;
+    }
+    // frames come out in display order. leading pictures of an open GOP can not be decoded without the previous one
+    qSort(pts_list);
+    while (frames.size() > pts_list.size())
+        frames.removeFirst();
+    gop->pts = pts_list.mid(pts_list.size() - frames.size());
+    gop->frames = frames;
+    gop->bytes = bytes;
+    if (gop->end < gop->pts.last())
+        gop->end = gop->pts.last();
+    return true;
+}
+
+} //namespace QtAV
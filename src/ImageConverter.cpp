@@ -27,6 +27,9 @@
 
 namespace QtAV {
 
+// outputs kept for reuse. e.g. 1 painted, 1 queued and 1 being converted
+static const int kMaxOutBuffers = 3;
+
 FACTORY_DEFINE(ImageConverter)
 
 extern void RegisterImageConverterFF_Man();
@@ -118,6 +121,34 @@ void ImageConverter::setOutFormat(int format)
     prepareData();
 }
 
+void ImageConverter::setInColorSpace(int cs)
+{
+    DPTR_D(ImageConverter);
+    if (d.cs_in == cs)
+        return;
+    d.cs_in = cs;
+    setupColorspaceDetails();
+}
+
+int ImageConverter::inColorSpace() const
+{
+    return d_func().cs_in;
+}
+
+void ImageConverter::setInRange(int range)
+{
+    DPTR_D(ImageConverter);
+    if (d.range_in == range)
+        return;
+    d.range_in = range;
+    setupColorspaceDetails();
+}
+
+int ImageConverter::inRange() const
+{
+    return d_func().range_in;
+}
+
 void ImageConverter::setInterlaced(bool interlaced)
 {
     d_func().interlaced = interlaced;
@@ -197,6 +228,28 @@ bool ImageConverter::setupColorspaceDetails()
     return true;
 }
 
+void ImageConverter::detachOutData()
+{
+    DPTR_D(ImageConverter);
+    if (d.data_out.isEmpty() || d.data_out.isDetached())
+        return;
+    // the renderers still hold the last output. take a buffer they released instead of allocating
+    const int bytes = d.data_out.size();
+    QByteArray out;
+    for (int i = d.out_pool.size() - 1; i >= 0; --i) {
+        if (d.out_pool.at(i).size() != bytes) {
+            d.out_pool.removeAt(i);
+            continue;
+        }
+        if (out.isEmpty() && d.out_pool.at(i).isDetached())
+            out = d.out_pool.takeAt(i);
+    }
+    if (d.out_pool.size() < kMaxOutBuffers)
+        d.out_pool.append(d.data_out);
+    d.data_out = out;
+    prepareData();
+}
+
 bool ImageConverter::prepareData()
 {
     DPTR_D(ImageConverter);
@@ -21,6 +21,8 @@
 
 #include <QtAV/ImageConverter.h>
 #include <private/ImageConverter_p.h>
+#include <QtAV/Tracer.h>
+#include <QtAV/Logging.h>
 #include <QtAV/QtAV_Compat.h>
 #include "prepost.h"
 
@@ -50,10 +52,30 @@ void RegisterImageConverterFF_Man()
 class ImageConverterFFPrivate : public ImageConverterPrivate
 {
 public:
+    // parameters sws_ctx is created with
+    struct ContextKey {
+        int w_in, h_in, fmt_in, w_out, h_out, fmt_out;
+        bool operator !=(const ContextKey& o) const {
+            return w_in != o.w_in || h_in != o.h_in || fmt_in != o.fmt_in
+                    || w_out != o.w_out || h_out != o.h_out || fmt_out != o.fmt_out;
+        }
+    };
+    // parameters applied by sws_setColorspaceDetails()
+    struct ColorKey {
+        int cs, range_in, range_out, brightness, contrast, saturation;
+        bool operator !=(const ColorKey& o) const {
+            return cs != o.cs || range_in != o.range_in || range_out != o.range_out
+                    || brightness != o.brightness || contrast != o.contrast || saturation != o.saturation;
+        }
+    };
+
     ImageConverterFFPrivate()
         : sws_ctx(0)
         , update_eq(true)
-    {}
+    {
+        memset(&ctx_key, 0, sizeof(ctx_key));
+        memset(&color_key, 0, sizeof(color_key));
+    }
     ~ImageConverterFFPrivate() {
         if (sws_ctx) {
             sws_freeContext(sws_ctx);
@@ -62,9 +84,36 @@ public:
     }
 
     SwsContext *sws_ctx;
-    bool update_eq;
+    ContextKey ctx_key;
+    ColorKey color_key;
+    bool update_eq; // color_key is not applied to sws_ctx
 };
 
+static bool isRGBFormat(int fffmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)fffmt);
+    return desc && (desc->flags & AV_PIX_FMT_FLAG_RGB) == AV_PIX_FMT_FLAG_RGB;
+}
+
+// AVColorSpace => SWS_CS_XXX
+static int swsColorSpace(int cs, int height)
+{
+    switch (cs) {
+    case AVCOL_SPC_BT709:
+        return SWS_CS_ITU709;
+    case AVCOL_SPC_FCC:
+        return SWS_CS_FCC;
+    case AVCOL_SPC_SMPTE240M:
+        return SWS_CS_SMPTE240M;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+        return SWS_CS_ITU601;
+    default:
+        // unspecified. HD is usually bt709
+        return height >= 720 ? SWS_CS_ITU709 : SWS_CS_ITU601;
+    }
+}
+
 ImageConverterFF::ImageConverterFF()
     :ImageConverter(*new ImageConverterFFPrivate())
 {
@@ -89,24 +138,32 @@ bool ImageConverterFF::check() const
 bool ImageConverterFF::convert(const quint8 *const srcSlice[], const int srcStride[])
 {
     DPTR_D(ImageConverterFF);
+    Tracer::Scope trace("convert", "video");
     //Check out dimension. equals to in dimension if not setted. TODO: move to another common func
     if (d.w_out == 0 || d.h_out == 0) {
         if (d.w_in == 0 || d.h_in == 0)
             return false;
         setOutSize(d.w_in, d.h_in);
     }
-//TODO: move those code to prepare()
-    d.sws_ctx = sws_getCachedContext(d.sws_ctx
-            , d.w_in, d.h_in, (AVPixelFormat)d.fmt_in
-            , d.w_out, d.h_out, (AVPixelFormat)d.fmt_out
-            , (d.w_in == d.w_out && d.h_in == d.h_out) ? SWS_POINT : SWS_FAST_BILINEAR //SWS_BICUBIC
-            , NULL, NULL, NULL
-            );
-    //int64_t flags = SWS_CPU_CAPS_SSE2 | SWS_CPU_CAPS_MMX | SWS_CPU_CAPS_MMX2;
-    //av_opt_set_int(d.sws_ctx, "sws_flags", flags, 0);
-    if (!d.sws_ctx)
-        return false;
-    setupColorspaceDetails();
+    detachOutData();
+    const ImageConverterFFPrivate::ContextKey key = { d.w_in, d.h_in, d.fmt_in, d.w_out, d.h_out, d.fmt_out };
+    if (!d.sws_ctx || key != d.ctx_key) {
+        d.sws_ctx = sws_getCachedContext(d.sws_ctx
+                , d.w_in, d.h_in, (AVPixelFormat)d.fmt_in
+                , d.w_out, d.h_out, (AVPixelFormat)d.fmt_out
+                , (d.w_in == d.w_out && d.h_in == d.h_out) ? SWS_POINT : SWS_FAST_BILINEAR //SWS_BICUBIC
+                , NULL, NULL, NULL
+                );
+        //int64_t flags = SWS_CPU_CAPS_SSE2 | SWS_CPU_CAPS_MMX | SWS_CPU_CAPS_MMX2;
+        //av_opt_set_int(d.sws_ctx, "sws_flags", flags, 0);
+        if (!d.sws_ctx)
+            return false;
+        d.ctx_key = key;
+        // the context may be a new one with default colorspace details
+        d.update_eq = true;
+    }
+    if (d.update_eq)
+        setupColorspaceDetails();
 #if PREPAREDATA_NO_PICTURE //for YUV420 <=> RGB
 #if 0
     struct
@@ -147,7 +204,7 @@ bool ImageConverterFF::convert(const quint8 *const srcSlice[], const int srcStri
 #endif //PREPAREDATA_NO_PICTURE
     int result_h = sws_scale(d.sws_ctx, srcSlice, srcStride, 0, d.h_in, d.picture.data, d.picture.linesize);
     if (result_h != d.h_out) {
-        qDebug("convert failed: %d, %d", result_h, d.h_out);
+        QTAV_DEBUG_LIMITED(LogVideo, "convert failed: %d, %d", result_h, d.h_out);
         return false;
     }
 #if 0
@@ -167,19 +224,23 @@ bool ImageConverterFF::setupColorspaceDetails()
         d.update_eq = true;
         return false;
     }
-    //if (!d.update_eq)
-    //    return true;
-    // FIXME: how to fill the ranges?
-    const int srcRange = 1;
-    const int dstRange = 0;
-    // TODO: SWS_CS_DEFAULT?
-    sws_setColorspaceDetails(d.sws_ctx, sws_getCoefficients(SWS_CS_DEFAULT)
-                             , srcRange, sws_getCoefficients(SWS_CS_DEFAULT)
+    // rgb is always full range. yuv => yuv keeps the range
+    const int srcRange = isRGBFormat(d.fmt_in) || d.range_in == AVCOL_RANGE_JPEG;
+    const int dstRange = isRGBFormat(d.fmt_out) ? 1 : srcRange;
+    const ImageConverterFFPrivate::ColorKey key = {
+        swsColorSpace(d.cs_in, d.h_in), srcRange, dstRange, d.brightness, d.contrast, d.saturation
+    };
+    if (!d.update_eq && !(key != d.color_key))
+        return true;
+    const int *coeffs = sws_getCoefficients(key.cs);
+    sws_setColorspaceDetails(d.sws_ctx, coeffs
+                             , srcRange, coeffs
                              , dstRange
                              , ((d.brightness << 16) + 50)/100
                              , (((d.contrast + 100) << 16) + 50)/100
                              , (((d.saturation + 100) << 16) + 50)/100
                              );
+    d.color_key = key;
     // TODO: b, c, s map function?
     //sws_init_context(d.sws_ctx, NULL, NULL);
     d.update_eq = false;
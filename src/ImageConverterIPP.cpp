@@ -21,6 +21,7 @@
 
 #include <QtAV/ImageConverter.h>
 #include <private/ImageConverter_p.h>
+#include <QtAV/Tracer.h>
 #include <QtAV/QtAV_Compat.h>
 #include "prepost.h"
 
@@ -67,6 +68,8 @@ ImageConverterIPP::ImageConverterIPP()
 bool ImageConverterIPP::convert(const quint8 *const srcSlice[], const int srcStride[])
 {
     DPTR_D(ImageConverterIPP);
+    Tracer::Scope trace("convert", "video");
+    detachOutData();
     //color convertion, no scale
 #ifdef IPP_LINK
     struct {
@@ -0,0 +1,147 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/Logging.h"
+#include "QtAV/Statistics.h"
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace QtAV {
+
+namespace Internal {
+int log_level[LogCategoryCount] = { LogDebug, LogDebug, LogDebug, LogDebug, LogDebug, LogDebug };
+} //namespace Internal
+
+namespace {
+static const char* kCategoryNames[] = { "core", "demux", "decoder", "audio", "video", "output" };
+static int sRateLimit = 5;
+
+static int levelFromName(const QByteArray& name)
+{
+    if (name == "off" || name == "0")
+        return LogOff;
+    if (name == "warning" || name == "1")
+        return LogWarning;
+    if (name == "debug" || name == "2")
+        return LogDebug;
+    return -1;
+}
+
+// QTAV_LOG=debug,demux=warning,audio=off
+class EnvLogLevel {
+public:
+    EnvLogLevel() {
+        const QByteArray env(qgetenv("QTAV_LOG").toLower());
+        if (env.isEmpty())
+            return;
+        foreach (const QByteArray& item, env.split(',')) {
+            const int eq = item.indexOf('=');
+            if (eq < 0) {
+                const int level = levelFromName(item.trimmed());
+                if (level >= 0)
+                    setLogLevel((LogLevel)level);
+                continue;
+            }
+            const QByteArray name(item.left(eq).trimmed());
+            const int level = levelFromName(item.mid(eq + 1).trimmed());
+            if (level < 0)
+                continue;
+            for (int i = 0; i < LogCategoryCount; ++i) {
+                if (name == kCategoryNames[i])
+                    setLogLevel((LogLevel)level, (LogCategory)i);
+            }
+        }
+    }
+};
+static EnvLogLevel sEnvLogLevel;
+
+static void print(LogLevel level, const QString& msg)
+{
+    if (level == LogWarning)
+        qWarning("%s", msg.toUtf8().constData());
+    else
+        qDebug("%s", msg.toUtf8().constData());
+}
+} //namespace
+
+void setLogLevel(LogLevel level, LogCategory category)
+{
+    if (category == LogCategoryCount) {
+        for (int i = 0; i < LogCategoryCount; ++i)
+            Internal::log_level[i] = level;
+        return;
+    }
+    Internal::log_level[category] = level;
+}
+
+LogLevel logLevel(LogCategory category)
+{
+    return (LogLevel)Internal::log_level[category];
+}
+
+void setLogRateLimit(int perSecond)
+{
+    sRateLimit = qMax(perSecond, 0);
+}
+
+int logRateLimit()
+{
+    return sRateLimit;
+}
+
+void logMessage(LogLevel level, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    QString msg;
+    msg.vsprintf(fmt, ap);
+    va_end(ap);
+    print(level, msg);
+}
+
+void logMessageLimited(LogLimiter *limiter, LogLevel level, const char *fmt, ...)
+{
+    int suppressed = 0;
+    if (sRateLimit > 0) {
+        // 0 is the initial value
+        const int second = int(Statistics::timestamp()/1000000LL) + 1;
+        const int last = limiter->second.fetchAndAddRelaxed(0);
+        if (last != second && limiter->second.testAndSetRelaxed(last, second)) {
+            limiter->count.fetchAndStoreRelaxed(0);
+            suppressed = limiter->suppressed.fetchAndStoreRelaxed(0);
+        }
+        if (limiter->count.fetchAndAddRelaxed(1) >= sRateLimit) {
+            limiter->suppressed.fetchAndAddRelaxed(1);
+            return;
+        }
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    QString msg;
+    msg.vsprintf(fmt, ap);
+    va_end(ap);
+    if (suppressed > 0)
+        msg += QString::fromLatin1(" (%1 similar messages suppressed)").arg(suppressed);
+    print(level, msg);
+}
+
+} //namespace QtAV
@@ -20,12 +20,106 @@
 ******************************************************************************/
 
 #include <QWidget>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
 #include "QtAV/AVPlayer.h"
 #include "QtAV/OutputSet.h"
 #include "QtAV/VideoRenderer.h"
+#include "QtAV/ImageConverter.h"
+#include "QtAV/ImageConverterTypes.h"
+#include "QtAV/Statistics.h"
+#include "QtAV/WorkerPool.h"
+#include "QtAV/QtAV_Compat.h"
 
 namespace QtAV {
 
+namespace {
+// outputs requesting the same format and size share one converted frame
+struct FrameGroup {
+    FrameGroup() : format(0), eq(false), conv(0), ok(false) {}
+    int format; //ffmpeg pixel format
+    QSize size;
+    bool eq; // apply brightness, contrast and saturation in converter
+    QList<VideoRenderer*> renderers;
+    ImageConverter *conv;
+    VideoFrame frame;
+    bool ok;
+};
+
+static const int kMaxConverters = 8;
+
+static quint64 groupKey(int format, const QSize& size, bool eq)
+{
+    return (quint64(eq) << 56) | (quint64(format & 0xffff) << 40) | (quint64(size.width() & 0xfffff) << 20) | quint64(size.height() & 0xfffff);
+}
+
+static void convertGroup(const VideoFrame& src, FrameGroup *g)
+{
+    ImageConverter *conv = g->conv;
+    // EQ is set on the converter of the video thread
+    ImageConverter *eq = src.imageConverter();
+    if (eq && g->eq) {
+        conv->setBrightness(eq->brightness());
+        conv->setContrast(eq->contrast());
+        conv->setSaturation(eq->saturation());
+    } else {
+        conv->setBrightness(0);
+        conv->setContrast(0);
+        conv->setSaturation(0);
+    }
+    conv->setInFormat(src.pixelFormatFFmpeg());
+    conv->setInSize(src.width(), src.height());
+    conv->setInColorSpace(src.colorSpace());
+    conv->setInRange(src.colorRange());
+    conv->setOutFormat(g->format);
+    conv->setOutSize(g->size.width(), g->size.height());
+    const quint8 *planes[4] = { 0, 0, 0, 0 };
+    int strides[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < qMin(src.planeCount(), 4); ++i) {
+        planes[i] = src.bits(i);
+        strides[i] = src.bytesPerLine(i);
+    }
+    if (!conv->convert(planes, strides)) {
+        g->ok = false;
+        return;
+    }
+    VideoFormat fmt(g->format);
+    QVector<quint8*> out_planes = conv->outPlanes();
+    QVector<int> out_line_sizes = conv->outLineSizes();
+    out_planes.resize(fmt.planeCount());
+    out_line_sizes.resize(fmt.planeCount());
+    g->frame = VideoFrame(conv->outData(), g->size.width(), g->size.height(), fmt);
+    g->frame.setBits(out_planes);
+    g->frame.setBytesPerLine(out_line_sizes);
+    if (fmt.isRGB()) {
+        g->frame.setColorRange(AVCOL_RANGE_JPEG);
+    } else {
+        // range is kept for yuv => yuv
+        g->frame.setColorSpace(src.colorSpace());
+        g->frame.setColorRange(src.colorRange());
+    }
+    g->ok = true;
+}
+
+class ConvertTask : public QRunnable
+{
+public:
+    ConvertTask(const VideoFrame& src, FrameGroup *group, QSemaphore *done)
+        : frame(src)
+        , g(group)
+        , sem(done)
+    {}
+    void run() {
+        convertGroup(frame, g);
+        sem->release();
+    }
+private:
+    VideoFrame frame;
+    FrameGroup *g;
+    QSemaphore *sem;
+};
+} //namespace
+
 OutputSet::OutputSet(AVPlayer *player):
     QObject(player)
   , mCanPauseThread(false)
@@ -39,6 +133,8 @@ OutputSet::~OutputSet()
     mCond.wakeAll();
     //delete? may be deleted by vo's parent
     clearOutputs();
+    qDeleteAll(mConverters);
+    mConverters.clear();
 }
 
 void OutputSet::lock()
@@ -62,10 +158,116 @@ void OutputSet::sendVideoFrame(const VideoFrame &frame)
     Q_UNUSED(lock);
     if (mOutputs.isEmpty())
         return;
+    const int fmt_in = frame.pixelFormatFFmpeg();
+    ImageConverter *eq = frame.imageConverter();
+    // converting to the same format is still required to apply the software EQ
+    const bool eq_changed = eq && (eq->brightness() || eq->contrast() || eq->saturation());
+    const int b = eq ? eq->brightness() : 0;
+    const int c = eq ? eq->contrast() : 0;
+    const int s = eq ? eq->saturation() : 0;
+    QList<FrameGroup> groups;
     foreach(AVOutput *output, mOutputs) {
         if (!output->isAvailable())
             continue;
-        ((VideoRenderer*)output)->receive(frame);
+        VideoRenderer *vo = static_cast<VideoRenderer*>(output);
+        int fmt = fmt_in;
+        if (!vo->isSupported(frame.pixelFormat()))
+            fmt = VideoFormat::pixelFormatToFFmpeg(vo->preferredPixelFormat());
+        QSize size = frame.size();
+        // the renderer draws the frame as is, so scale to the displayed size
+        if (!vo->scaleInRenderer() && vo->videoRect().isValid())
+            size = vo->videoRect().size();
+        // skip cpu eq if the renderer can do it. it takes effect on the next draw
+        bool cpu_eq = eq_changed;
+        if (vo->isEQSupported()) {
+            vo->setEQ(b, c, s);
+            cpu_eq = false;
+        }
+        int i = 0;
+        for (; i < groups.size(); ++i) {
+            if (groups[i].format == fmt && groups[i].size == size && groups[i].eq == cpu_eq)
+                break;
+        }
+        if (i == groups.size()) {
+            FrameGroup g;
+            g.format = fmt;
+            g.size = size;
+            g.eq = cpu_eq;
+            groups.append(g);
+        }
+        groups[i].renderers.append(vo);
+    }
+    // groups need conversion. the 1st one is converted in current thread
+    QList<FrameGroup*> pending;
+    for (int i = 0; i < groups.size(); ++i) {
+        FrameGroup &g = groups[i];
+        if (g.format == fmt_in && g.size == frame.size() && !g.eq) {
+            // renderers keep the frame until it is painted. a refcounted decoded frame is kept without copy,
+            // otherwise the decoded planes are reused by the next decode, e.g. old FFmpeg or hw decoders
+            if (!frame.isBufferOwned()) {
+                g.frame = frame.clone();
+                g.frame.setColorSpace(frame.colorSpace());
+                g.frame.setColorRange(frame.colorRange());
+            } else {
+                g.frame = frame;
+            }
+            g.ok = true;
+            continue;
+        }
+        const quint64 key = groupKey(g.format, g.size, g.eq);
+        g.conv = mConverters.value(key);
+        if (!g.conv) {
+            g.conv = ImageConverterFactory::create(ImageConverterId_FF);
+            if (!g.conv)
+                continue;
+            mConverters.insert(key, g.conv);
+        }
+        pending.append(&g);
+    }
+    Statistics::Pipeline *pipeline = mpPlayer ? &mpPlayer->statistics().video_pipeline : 0;
+    qint64 t = Statistics::timestamp();
+    if (!pending.isEmpty()) {
+        QSemaphore done;
+        // the player's frames are waiting. its priority decides who goes first when the pool is busy
+        const int priority = mpPlayer ? mpPlayer->workerPriority() : 0;
+        for (int i = 1; i < pending.size(); ++i) {
+            WorkerPool::instance().start(new ConvertTask(frame, pending[i], &done), priority);
+        }
+        convertGroup(frame, pending.first());
+        done.acquire(pending.size() - 1);
+        if (pipeline) {
+            const qint64 t1 = Statistics::timestamp();
+            pipeline->addLatency(Statistics::Pipeline::Convert, t1 - t);
+            t = t1;
+        }
+    }
+    foreach (const FrameGroup& g, groups) {
+        if (!g.ok)
+            continue;
+        foreach (VideoRenderer *vo, g.renderers) {
+            vo->receive(g.frame);
+        }
+    }
+    if (pipeline)
+        pipeline->addLatency(Statistics::Pipeline::Render, Statistics::timestamp() - t);
+    // e.g. renderer is resized many times. drop the converters not used by this frame
+    if (mConverters.size() > kMaxConverters) {
+        QHash<quint64, ImageConverter*>::iterator it = mConverters.begin();
+        while (it != mConverters.end()) {
+            bool used = false;
+            foreach (FrameGroup *g, pending) {
+                if (g->conv == it.value()) {
+                    used = true;
+                    break;
+                }
+            }
+            if (used) {
+                ++it;
+                continue;
+            }
+            delete it.value();
+            it = mConverters.erase(it);
+        }
     }
 }
 
@@ -20,6 +20,7 @@
 ******************************************************************************/
 
 #include <QtAV/Packet.h>
+#include <QtAV/Logging.h>
 
 namespace QtAV {
 
@@ -28,14 +29,16 @@ const qreal Packet::kEndPts = -0.618;
 Packet::Packet()
     : hasKeyFrame(false)
     , isCorrupt(false)
+    , drain(false)
     , pts(0)
     , duration(0)
+    , read_time(0)
 {
 }
 
 void Packet::markEnd()
 {
-    qDebug("mark as end packet");
+    QTAV_DEBUG(LogDemux, "mark as end packet");
     pts = kEndPts;
 }
 
@@ -0,0 +1,316 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/PlayerGroup.h"
+#include <QtCore/QTimerEvent>
+#include "QtAV/AVClock.h"
+#include "QtAV/AVPlayer.h"
+#include "QtAV/WorkerPool.h"
+#include "QtAV/QtAV_Compat.h"
+
+namespace QtAV {
+
+static const int kSyncInterval = 200;
+// s. the measured drift is removed in about this time
+static const qreal kCorrectionTime = 1.0;
+// s. players closer than this run at the group's speed
+static const qreal kMinDrift = 0.002;
+// the video pts is updated once per frame. the lag is averaged over about 1/kLagSmoothing syncs
+static const qreal kLagSmoothing = 0.25;
+
+PlayerGroup::PlayerGroup(QObject *parent)
+    : QObject(parent)
+    , clock(0)
+    , timer_id(-1)
+    , interval(kSyncInterval)
+    , max_rate(0.05)
+    , jump_threshold(0.5)
+    , max_drift(0)
+    , base_speed(1.0)
+    , resync(true)
+{
+    clock = new AVClock(AVClock::ExternalClock, this);
+}
+
+PlayerGroup::~PlayerGroup()
+{
+    stopSync();
+    WorkerPool::instance().releaseDecoders(group.size());
+}
+
+AVClock* PlayerGroup::masterClock()
+{
+    return clock;
+}
+
+void PlayerGroup::addPlayer(AVPlayer *player)
+{
+    if (!player || group.contains(player))
+        return;
+    AVClock *c = player->masterClock();
+    c->setClockAuto(false);
+    c->setClockType(AVClock::ExternalClock);
+    group.append(player);
+    // each player decodes 1 video stream. share the codec threads with the players opened later
+    WorkerPool::instance().reserveDecoders(1);
+    connect(player, SIGNAL(destroyed(QObject*)), this, SLOT(removeDestroyedPlayer(QObject*)));
+    resync = true;
+}
+
+void PlayerGroup::removePlayer(AVPlayer *player)
+{
+    if (!group.removeAll(player))
+        return;
+    disconnect(player, 0, this, 0);
+    lag.remove(player);
+    WorkerPool::instance().releaseDecoders(1);
+    // the rate adjustment
+    player->masterClock()->setSpeed(player->speed());
+}
+
+QList<AVPlayer*> PlayerGroup::players() const
+{
+    return group;
+}
+
+void PlayerGroup::setSyncInterval(int ms)
+{
+    if (interval == ms)
+        return;
+    interval = ms;
+    if (timer_id < 0)
+        return;
+    stopSync();
+    startSync();
+}
+
+int PlayerGroup::syncInterval() const
+{
+    return interval;
+}
+
+void PlayerGroup::setMaxRateAdjustment(qreal r)
+{
+    max_rate = qBound<qreal>(0, r, 0.5);
+}
+
+qreal PlayerGroup::maxRateAdjustment() const
+{
+    return max_rate;
+}
+
+void PlayerGroup::setJumpThreshold(qreal s)
+{
+    jump_threshold = s;
+}
+
+qreal PlayerGroup::jumpThreshold() const
+{
+    return jump_threshold;
+}
+
+qreal PlayerGroup::drift() const
+{
+    return max_drift;
+}
+
+qreal PlayerGroup::speed() const
+{
+    return base_speed;
+}
+
+void PlayerGroup::play(const QString &file)
+{
+    stop();
+    // opened by play()
+    foreach (AVPlayer *player, group) {
+        player->setFile(file);
+    }
+    play();
+}
+
+void PlayerGroup::play()
+{
+    clock->reset();
+    clock->setSpeed(base_speed);
+    // open all players paused, so that no player starts before the others are opened
+    foreach (AVPlayer *player, group) {
+        player->play();
+        player->pause(true);
+    }
+    clock->start();
+    foreach (AVPlayer *player, group) {
+        player->pause(false);
+    }
+    // players' clocks start when the 1st packet is read
+    resync = true;
+    startSync();
+}
+
+void PlayerGroup::stop()
+{
+    stopSync();
+    foreach (AVPlayer *player, group) {
+        player->stop();
+    }
+    clock->reset();
+}
+
+void PlayerGroup::pause(bool p)
+{
+    clock->pause(p);
+    foreach (AVPlayer *player, group) {
+        player->pause(p);
+    }
+    // clocks paused at different time
+    if (!p)
+        sync(true);
+    emit paused(p);
+}
+
+void PlayerGroup::togglePause()
+{
+    pause(clock->isActive());
+}
+
+void PlayerGroup::seek(qint64 pos)
+{
+    const bool was_paused = !clock->isActive();
+    clock->updateExternalClock(pos);
+    if (was_paused)
+        clock->pause(true);
+    foreach (AVPlayer *player, group) {
+        player->seek(pos);
+    }
+    resync = true;
+}
+
+void PlayerGroup::setSpeed(qreal speed)
+{
+    if (speed == base_speed)
+        return;
+    base_speed = speed;
+    clock->setSpeed(speed);
+    foreach (AVPlayer *player, group) {
+        player->setSpeed(speed);
+    }
+}
+
+void PlayerGroup::playNextFrame()
+{
+    if (group.isEmpty())
+        return;
+    foreach (AVPlayer *player, group) {
+        player->playNextFrame();
+    }
+    clock->updateExternalClock(*group.first()->masterClock());
+    clock->pause(true);
+}
+
+void PlayerGroup::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() != timer_id)
+        return;
+    sync(resync);
+    resync = false;
+}
+
+void PlayerGroup::removeDestroyedPlayer(QObject *obj)
+{
+    AVPlayer *player = static_cast<AVPlayer*>(obj);
+    lag.remove(player);
+    if (group.removeAll(player))
+        WorkerPool::instance().releaseDecoders(1);
+}
+
+void PlayerGroup::sync(bool jump)
+{
+    if (!clock->isActive())
+        return;
+    /*
+     * the players' clocks follow the master exactly, so they can not show the drift. what a player presents is
+     * measured instead: the pts of its last video frame behind the master. the lag of a player in sync is about
+     * half a frame, so a player is corrected by its lag relative to the group's mean lag
+     */
+    QList<AVPlayer*> active;
+    qreal lag_sum = 0;
+    const qreal master = clock->value();
+    foreach (AVPlayer *player, group) {
+        if (!player->isPlaying() || player->isPaused())
+            continue;
+        AVClock *c = player->masterClock();
+        if (!c->isActive())
+            continue;
+        if (jump || qAbs(c->value() - master) > jump_threshold) {
+            c->updateExternalClock(*clock);
+            c->setSpeed(base_speed);
+            lag.remove(player);
+            continue;
+        }
+        const qreal l = c->videoPts() - master;
+        // no frame since seek, or a stall. not a drift the rate can correct
+        if (qAbs(l) > jump_threshold) {
+            c->setSpeed(base_speed);
+            continue;
+        }
+        QHash<AVPlayer*, qreal>::iterator it = lag.find(player);
+        if (it == lag.end())
+            it = lag.insert(player, l);
+        else
+            it.value() += (l - it.value())*kLagSmoothing;
+        lag_sum += it.value();
+        active.append(player);
+    }
+    qreal drift_max = 0;
+    if (active.size() > 1) {
+        const qreal mean = lag_sum/qreal(active.size());
+        foreach (AVPlayer *player, active) {
+            AVClock *c = player->masterClock();
+            const qreal drift = lag.value(player) - mean;
+            drift_max = qMax(drift_max, qAbs(drift));
+            if (qAbs(drift) < kMinDrift) {
+                c->setSpeed(base_speed);
+                continue;
+            }
+            // ahead: slow down. behind: speed up
+            const qreal adjust = qBound(-max_rate, -drift/kCorrectionTime, max_rate);
+            c->setSpeed(base_speed*(1.0 + adjust));
+        }
+    }
+    max_drift = drift_max;
+}
+
+void PlayerGroup::startSync()
+{
+    if (timer_id >= 0)
+        return;
+    timer_id = startTimer(interval);
+}
+
+void PlayerGroup::stopSync()
+{
+    if (timer_id < 0)
+        return;
+    killTimer(timer_id);
+    timer_id = -1;
+}
+
+} //namespace QtAV
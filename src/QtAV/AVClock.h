@@ -23,6 +23,8 @@
 #define QTAV_AVCLOCK_H
 
 #include <QtAV/QtAV_Global.h>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
 #include <QtCore/QElapsedTimer>
@@ -36,6 +38,10 @@ typedef QTime QElapsedTimer;
  * The default clock type is Audio's clock, i.e. vedio synchronizes to audio. If audio stream is not
  * detected, then the clock will set to External clock automatically.
  * I name it ExternalClock because the clock can be corrected outside, though it is a clock inside AVClock
+ *
+ * Thread safety: the clock state is an immutable snapshot published by a seqlock. Readers (value(), pts() etc.)
+ * never lock and have no side effects, so audio, video and gui threads can read it at any time.
+ * Writers are serialized by a mutex.
  */
 namespace QtAV {
 
@@ -60,21 +66,27 @@ public:
     void setClockAuto(bool a);
     bool isClockAuto() const;
     /*in seconds*/
-    inline double pts() const;
-    inline double value() const; //the real timestamp: pts + delay
-    inline void updateValue(double pts); //update the pts
+    double pts() const;
+    double value() const; //the real timestamp: pts + delay
+    void updateValue(double pts); //update the pts
     /*used when seeking and correcting from external*/
     void updateExternalClock(qint64 msecs);
     /*external clock outside still running, so it's more accurate for syncing multiple clocks serially*/
     void updateExternalClock(const AVClock& clock);
 
-    inline void updateVideoPts(double pts);
-    inline double videoPts() const;
-    inline double delay() const; //playing audio spends some time
-    inline void updateDelay(double delay);
+    void updateVideoPts(double pts);
+    double videoPts() const;
+    double delay() const; //playing audio spends some time
+    void updateDelay(double delay);
+    /*!
+     * audio clock only. pts() + delay() is the end of the data written to the audio device,
+     * latency is the duration of the data queued in the device but not played yet (AudioOutput::latency()).
+     * Then value() is the audible time. It is extrapolated between updates and small drift is smoothed.
+     */
+    void updateAudioLatency(double latency);
 
     void setSpeed(qreal speed);
-    inline qreal speed() const;
+    qreal speed() const;
 
 signals:
     void paused(bool);
@@ -93,59 +105,35 @@ public slots:
     void reset();
 
 private:
+    /*
+     * value at time t(us of the monotonic timer) is base + (t - time)*speed.
+     * time < 0: not running, value is base
+     */
+    struct State {
+        ClockType type;
+        double pts; //audio: pts of the written data
+        double delay; //audio: duration written after pts
+        double pts_v;
+        double base;
+        qint64 time;
+        double speed;
+        bool audio_sync; //audio: base and time are computed from the device latency
+    };
+    // consistent copy of the published state. lock free
+    State snapshot() const;
+    // must be called with write_mutex locked
+    void publish(const State& s);
+    qint64 now() const;
+    static double valueOf(const State& s, qint64 t);
+
     bool auto_clock;
-    ClockType clock_type;
-    mutable double pts_;
-    double pts_v;
-    double delay_;
-    mutable QElapsedTimer timer;
-    qreal mSpeed;
+    State state;
+    // odd while publishing
+    mutable QAtomicInt seq;
+    QMutex write_mutex;
+    // monotonic, never restarted
+    QElapsedTimer timer;
 };
 
-double AVClock::value() const
-{
-    if (clock_type == AudioClock) {
-        return pts_ + delay_;
-    } else {
-        if (timer.isValid()) {
-            pts_ += double(timer.restart()) * kThousandth;
-        } else {//timer is paused
-            qDebug("clock is paused. return the last value %f", pts_);
-        }
-        return pts_ * speed();
-    }
-}
-
-void AVClock::updateValue(double pts)
-{
-    if (clock_type == AudioClock)
-        pts_ = pts;
-}
-
-void AVClock::updateVideoPts(double pts)
-{
-    pts_v = pts;
-}
-
-double AVClock::videoPts() const
-{
-    return pts_v;
-}
-
-double AVClock::delay() const
-{
-    return delay_;
-}
-
-void AVClock::updateDelay(double delay)
-{
-    delay_ = delay;
-}
-
-qreal AVClock::speed() const
-{
-    return mSpeed;
-}
-
 } //namespace QtAV
 #endif // QTAV_AVCLOCK_H
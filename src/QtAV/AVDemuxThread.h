@@ -26,11 +26,20 @@
 #include <QtCore/QThread>
 #include <QtCore/QWaitCondition>
 #include <QtAV/QtAV_Global.h>
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+#include <QtCore/QElapsedTimer>
+#else
+#include <QtCore/QTime>
+typedef QTime QElapsedTimer;
+#endif
 
 namespace QtAV {
 
 class AVDemuxer;
 class AVThread;
+class Packet;
+class Statistics;
+class PacketQueue;
 class Q_AV_EXPORT AVDemuxThread : public QThread
 {
     Q_OBJECT
@@ -42,7 +51,19 @@ public:
     AVThread* audioThread();
     void setVideoThread(AVThread *thread);
     AVThread* videoThread();
+    // record the read latency
+    void setStatistics(Statistics *s);
     void seek(qint64 pos); //ms
+    /*!
+     * \brief setTrickPlaySpeed
+     * Fast scanning. Audio packets are dropped and only video key frames are forwarded, so the cost is lower than normal playback.
+     * speed > 0: forward. key frames are read in order and paced to the speed. If reading can not keep up, skip ahead by seeking.
+     * speed < 0: rewind. seek back key frame to key frame.
+     * speed 0: normal playback. the caller should seek to resync audio and video.
+     * The external clock is updated to each forwarded key frame, so video thread presents it immediately.
+     */
+    void setTrickPlaySpeed(qreal speed);
+    qreal trickPlaySpeed() const;
     //AVDemuxer* demuxer
     bool isPaused() const;
     bool isEnd() const;
@@ -62,6 +83,12 @@ protected:
 
 private:
     void setAVThread(AVThread *&pOld, AVThread* pNew);
+    // called with buffer_mutex locked
+    void resetTrickPlay(PacketQueue *aqueue, PacketQueue *vqueue);
+    void forwardKeyFrame(const Packet& pkt, PacketQueue *vqueue);
+    void rewindStep(qreal speed, PacketQueue *vqueue);
+    // return false if interrupted by a state change
+    bool waitTrickPlay(qint64 ms);
     bool paused, seeking;
     volatile bool end;
     AVDemuxer *demuxer;
@@ -70,7 +97,18 @@ private:
     QMutex buffer_mutex;
     QWaitCondition cond, seek_cond;
 
+    mutable QMutex trick_mutex;
+    QWaitCondition trick_cond;
+    qreal trick_speed;
+    bool trick_reset;
+    QElapsedTimer trick_timer;
+    qint64 trick_start_time; //ms of trick_timer
+    qreal trick_start_pos; //s
+    qreal trick_last_key; //s
+    qint64 trick_last_forward; //ms of trick_timer
+
     int running_threads;
+    Statistics *statistics;
 };
 
 } //namespace QtAV
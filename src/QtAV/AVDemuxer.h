@@ -94,6 +94,12 @@ public:
     SeekTarget seekTarget() const;
     bool seek(qint64 pos); //pos: ms
     void seek(qreal q); //q: [0,1]. TODO: what if duration() is not valid?
+    /*!
+     * \brief seekToKeyFrame
+     * seek to the video key frame at or before pos(ms). Unlike seek(), calls are not throttled,
+     * so it can be used to decode frame accurately, e.g. a group of pictures for reverse playback
+     */
+    bool seekToKeyFrame(qint64 pos);
 
     //format
     AVFormatContext* formatContext();
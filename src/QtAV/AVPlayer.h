@@ -48,6 +48,7 @@ class AVDemuxThread;
 class Filter;
 class VideoCapture;
 class OutputSet;
+class ReverseThread;
 
 class Q_AV_EXPORT AVPlayer : public QObject
 {
@@ -170,6 +171,37 @@ public:
      */
     void setSpeed(qreal speed);
     qreal speed() const;
+    /*!
+     * \brief setTrickPlay
+     * Fast scanning with video key frames only, e.g. 8, 16 for fast forward and -8, -16 for rewind.
+     * Audio is not played while scanning. Costs less cpu than normal playback because only key frames are decoded.
+     * \param speed 0: normal playback continues from the current position
+     */
+    void setTrickPlay(qreal speed);
+    qreal trickPlay() const;
+    /*!
+     * \brief setReversePlayback
+     * Play video backward at speed(). Audio is not played. Groups of pictures are decoded
+     * from their key frames into a cache, so only local files are supported.
+     * \param r false: normal playback continues from the current position
+     */
+    void setReversePlayback(bool r);
+    bool isReversePlayback() const;
+    /*!
+     * \brief setFreeRun
+     * Decode as fast as the outputs accept frames, e.g. for analysis with VideoRendererNull and filters.
+     * The clock does not pace the threads and no frame is dropped. Audio is decoded and filtered but not played.
+     * Trick-play and reverse playback are not available in free run.
+     * \param r false: playback is paced by the clock again
+     */
+    void setFreeRun(bool r);
+    bool isFreeRun() const;
+    /*!
+     * \brief setReverseCacheSize
+     * memory budget of decoded frames for reverse playback and playPreviousFrame(). default is 256MB
+     */
+    void setReverseCacheSize(qint64 bytes);
+    qint64 reverseCacheSize() const;
 
     Statistics& statistics();
     const Statistics& statistics() const;
@@ -184,6 +216,13 @@ public:
 
     void setPriority(const QVector<VideoDecoderId>& ids);
     //void setPriority(const QVector<AudioOutputId>& ids);
+    /*!
+     * \brief setWorkerPriority
+     * priority of this player's tasks in WorkerPool, e.g. converting frames for renderers.
+     * Tasks of a player with higher priority run first when the pool is busy. default is 0
+     */
+    void setWorkerPriority(int priority);
+    int workerPriority() const;
 
     int brightness() const;
     int contrast() const;
@@ -211,6 +250,9 @@ signals:
     void started();
     void stopped();
     void speedChanged(qreal speed);
+    void trickPlayChanged(qreal speed);
+    void reversePlaybackChanged(bool r);
+    void freeRunChanged(bool r);
     void repeatChanged(int r);
     void currentRepeatChanged(int r);
     void startPositionChanged(qint64 position);
@@ -226,6 +268,8 @@ public slots:
     void play(); //replay
     void stop();
     void playNextFrame();
+    // step backward. playback is paused. resuming continues forward from the frame shown
+    void playPreviousFrame();
 
     /*!
      * \brief setRepeat
@@ -275,6 +319,8 @@ private slots:
     // start/stop notify timer in this thread. use QMetaObject::invokeMethod
     void startNotifyTimer();
     void stopNotifyTimer();
+    void reverseReachedStart();
+    void reverseStepped(qreal pts);
 
 protected:
     // TODO: set position check timer interval
@@ -284,6 +330,10 @@ private:
     void initStatistics();
     bool setupAudioThread();
     bool setupVideoThread();
+    // pause the pipeline and present frames from reverse_thread
+    bool enterReverse();
+    // restore the clock and seek to the current frame. the pipeline is still paused
+    void leaveReverse();
     template<class Out>
     void setAVOutput(Out*& pOut, Out* pNew, AVThread* thread);
     //TODO: addAVOutput()
@@ -322,11 +372,20 @@ private:
     VideoCapture *video_capture;
     Statistics mStatistics;
     qreal mSpeed;
+    qreal trick_speed;
+    AVClock::ClockType trick_clock_type; //restored when trick-play stops
+    ReverseThread *reverse_thread;
+    bool reverse_play; //playing backward
+    bool reverse_step; //paused at a frame shown by playPreviousFrame()
+    AVClock::ClockType reverse_clock_type;
+    bool free_run;
+    AVClock::ClockType free_run_clock_type; //restored when free run stops
     bool ao_enable;
     OutputSet *mpVOSet, *mpAOSet;
     QVector<VideoDecoderId> vcodec_ids;
 
     int mBrightness, mContrast, mSaturation;
+    int worker_priority;
 
     QHash<QByteArray, QByteArray> audio_codec_opt, video_codec_opt;
 };
@@ -65,6 +65,13 @@ public:
     OutputSet* outputSet() const;
 
     void setDemuxEnded(bool ended);
+    /*!
+     * \brief setFreeRun
+     * true: packets are processed as fast as possible, not paced by the clock and never dropped.
+     * The thread is slowed down only by the packet queue and the outputs
+     */
+    void setFreeRun(bool freeRun);
+    bool isFreeRun() const;
 
     bool isPaused() const;
 
@@ -76,6 +83,11 @@ public:
 
     // TODO: resample, resize task etc.
     void scheduleTask(QRunnable *task);
+    /*!
+     * wake up the thread waiting for a presentation deadline. called by stop(), pause() and seeking
+     * so that the new state takes effect immediately
+     */
+    void interruptWait();
 
 public slots:
     virtual void stop();
@@ -93,6 +105,14 @@ protected:
     // has timeout so that the pending tasks can be processed
     bool tryPause(int timeout = 100);
     bool processNextTask(); //in AVThread
+    // current time of the monotonic scheduler clock in us
+    qint64 monotonicTime() const;
+    /*!
+     * block until the monotonic time deadline (us, see monotonicTime()) is reached.
+     * Return false if stopped or interrupted by interruptWait(), then the caller should check the state again
+     */
+    bool waitUntil(qint64 deadline);
+    bool waitFor(qreal seconds);
 
     DPTR_DECLARE(AVThread)
 
@@ -23,6 +23,7 @@
 #define QAV_AUDIODECODER_H
 
 #include <QtAV/AVDecoder.h>
+#include <QtAV/AudioFrame.h>
 
 //TODO: decoder.in/outAudioFormat()?
 namespace QtAV {
@@ -36,6 +37,11 @@ public:
     AudioDecoder();
     virtual bool prepare();
     virtual bool decode(const QByteArray &encoded);
+    /*!
+     * the decoded (and resampled) samples. The frame shares the decoder's buffer, no copy.
+     * timestamp is not set
+     */
+    AudioFrame frame();
     AudioResampler *resampler();
 };
 
@@ -0,0 +1,107 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOFILTER_H
+#define QTAV_AUDIOFILTER_H
+
+#include <QtAV/Filter.h>
+#include <QtCore/QVector>
+
+/*
+ * Filters running in AudioThread on decoded AudioFrames, before the volume and output.
+ * example:
+ *    class MyFilter : public AudioFilter {
+ *    protected:
+ *        void process(Statistics*, AudioFrame* frame) { ... }
+ *    };
+ *    player->installAudioFilter(new MyFilter());
+ */
+namespace QtAV {
+
+class AudioFrame;
+class AudioFilterPrivate;
+class Q_AV_EXPORT AudioFilter : public Filter
+{
+    DPTR_DECLARE_PRIVATE(AudioFilter)
+public:
+    AudioFilter();
+    virtual ~AudioFilter();
+
+protected:
+    AudioFilter(AudioFilterPrivate& d);
+    /*!
+     * The frame data is shared with the decoder, modify it in place. A filter can also assign a new frame,
+     * e.g. with different channels, but the output format must be compatible with the audio output.
+     */
+    virtual void process(Statistics* statistics, AudioFrame* frame) = 0;
+
+private:
+    void process(Statistics* statistics, Frame* frame);
+};
+
+class VolumeFilterPrivate;
+/*!
+ * \brief The VolumeFilter class
+ * Vectorized gain with optional clipping for float samples. Integer samples are always saturated.
+ */
+class Q_AV_EXPORT VolumeFilter : public AudioFilter
+{
+    DPTR_DECLARE_PRIVATE(VolumeFilter)
+public:
+    VolumeFilter();
+    // linear gain. 1.0: unchanged
+    void setVolume(qreal volume);
+    qreal volume() const;
+    // clip float samples to [-1, 1] after gain. default is true
+    void setClipEnabled(bool enabled);
+    bool isClipEnabled() const;
+
+protected:
+    void process(Statistics* statistics, AudioFrame* frame);
+};
+
+class ChannelMixFilterPrivate;
+/*!
+ * \brief The ChannelMixFilter class
+ * Mix packed float frames down to less channels, e.g. 5.1 to stereo for a stereo device.
+ * The output format must have the same channels as the filter.
+ */
+class Q_AV_EXPORT ChannelMixFilter : public AudioFilter
+{
+    DPTR_DECLARE_PRIVATE(ChannelMixFilter)
+public:
+    ChannelMixFilter();
+    void setChannels(int channels);
+    int channels() const;
+    /*!
+     * out[c] = sum(matrix[c*in_channels + i] * in[i]). Empty (default): average all input channels.
+     * The matrix size must be channels()*in_channels.
+     */
+    void setMatrix(const QVector<float>& matrix);
+    QVector<float> matrix() const;
+
+protected:
+    void process(Statistics* statistics, AudioFrame* frame);
+};
+
+} //namespace QtAV
+
+#endif // QTAV_AUDIOFILTER_H
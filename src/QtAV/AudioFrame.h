@@ -23,6 +23,7 @@
 #define QTAV_AUDIOFRAME_H
 
 #include <QtAV/Frame.h>
+#include <QtAV/AudioFormat.h>
 
 namespace QtAV {
 
@@ -32,11 +33,32 @@ class Q_AV_EXPORT AudioFrame : public Frame
     Q_DECLARE_PRIVATE(AudioFrame)
 public:
     AudioFrame();
+    /*!
+     * The data is shared, not copied, e.g. the decoder's buffer. Planes and bytesPerLine are computed
+     * from the format and the data size. Planar data must be contiguous.
+     */
+    AudioFrame(const QByteArray& data, const AudioFormat& format);
     AudioFrame(const AudioFrame &other);
     virtual ~AudioFrame();
 
     AudioFrame &operator =(const AudioFrame &other);
 
+    bool isValid() const;
+    AudioFormat format() const;
+    int samplesPerChannel() const;
+    // pts in seconds
+    qreal timestamp() const;
+    void setTimestamp(qreal ts);
+    // in seconds
+    qreal duration() const;
+    /*!
+     * \brief mid
+     * samples [offset, offset + count) of this frame. The data is shared and timestamp is adjusted.
+     * Used to split a decoded frame without copying.
+     */
+    AudioFrame mid(int offset, int count) const;
+    // Deep copy
+    AudioFrame clone() const;
 };
 
 } //namespace QtAV
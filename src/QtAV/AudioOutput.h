@@ -33,6 +33,7 @@ class AudioOutput;
 FACTORY_DECLARE(AudioOutput)
 
 class AudioFormat;
+class AudioFrame;
 class AudioOutputPrivate;
 class Q_AV_EXPORT AudioOutput : public AVOutput
 {
@@ -42,6 +43,12 @@ public:
     virtual ~AudioOutput() = 0;
     /* store the data ref, then call convertData() and write(). tryPause() will be called*/
     bool receiveData(const QByteArray& data);
+    /*!
+     * Write the samples of a packed frame without copying. The frame format must be the same as audioFormat(),
+     * or its planar version, then the planes are interleaved into a buffer reused by the next frames.
+     * The output does not keep a reference to the frame data after return
+     */
+    bool receiveData(const AudioFrame& frame);
 
     int maxChannels() const;
     //virtual bool isSupported(const AudioFormat& format);
@@ -69,6 +76,25 @@ public:
      */
     void setSpeed(qreal speed);
     qreal speed() const;
+    /*!
+     * \brief latency
+     * The duration in seconds of the data written but not played by the device yet.
+     * The audible time is the end of the written data - latency(). Used by the audio clock for lip-sync.
+     * Called in the thread calling receiveData(). The default implementation returns 0
+     */
+    virtual qreal latency() const;
+    /*!
+     * \brief isRealtime
+     * true(default): the data is consumed at the sample rate, e.g. by a device. A free running player
+     * does not send audio to realtime outputs
+     */
+    virtual bool isRealtime() const;
+    /*!
+     * \brief clear
+     * Drop the data written but not played yet, e.g. when seeking. Called in the thread calling receiveData().
+     * The default implementation does nothing
+     */
+    virtual void clear();
 
 protected:
     AudioOutput(AudioOutputPrivate& d);
@@ -0,0 +1,69 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOOUTPUTNULL_H
+#define QTAV_AUDIOOUTPUTNULL_H
+
+#include <QtAV/AudioOutput.h>
+
+namespace QtAV {
+
+/*!
+ * \brief The AudioOutputNull class
+ * Audio output without a device. The samples are consumed against a monotonic clock like a real device,
+ * so the whole audio path runs in headless environments, CI and benchmarks.
+ */
+class AudioOutputNullPrivate;
+class Q_AV_EXPORT AudioOutputNull : public AudioOutput
+{
+    DPTR_DECLARE_PRIVATE(AudioOutputNull)
+public:
+    AudioOutputNull();
+    ~AudioOutputNull();
+
+    bool open();
+    bool close();
+    /*!
+     * \brief setRealtimeFactor
+     * 1.0(default): consume samples in realtime. 2.0: twice as fast as realtime.
+     * <= 0: no wait, as fast as possible.
+     */
+    void setRealtimeFactor(qreal factor);
+    qreal realtimeFactor() const;
+    // the duration of the emulated device buffer. default is 0.1s. takes effect in the next write()
+    void setBufferDuration(qreal seconds);
+    qreal bufferDuration() const;
+    // samples per channel played since open() or clear()
+    qint64 playedSamples() const;
+    // times all written samples were played before new data arrived
+    int underruns() const;
+    qreal latency() const;
+    // realtimeFactor() > 0
+    bool isRealtime() const;
+    // drops the samples not played. the emulated device restarts in the next write()
+    void clear();
+
+protected:
+    bool write();
+};
+
+} //namespace QtAV
+#endif // QTAV_AUDIOOUTPUTNULL_H
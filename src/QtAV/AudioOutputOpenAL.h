@@ -36,6 +36,22 @@ public:
     virtual bool close();
 
     QString name() const;
+    /*!
+     * The number and the size in bytes of OpenAL buffers. Default is 8 x 4096. Take effect in open().
+     * Latency is at most count*size. Smaller buffers reduce the latency but the audio thread wakes up more often.
+     */
+    void setBufferCount(int count);
+    int bufferCount() const;
+    void setBufferSize(int bytes);
+    int bufferSize() const;
+    // times the source stopped because all queued buffers were played. a pause counts once
+    int underruns() const;
+    // number of buffers queued in the source
+    int queuedBuffers() const;
+    // queued buffers + AL_SAMPLE_OFFSET
+    qreal latency() const;
+    // stops the source and unqueues all buffers. write() plays again
+    void clear();
 
 protected:
     virtual bool write();
@@ -37,6 +37,24 @@ public:
 
     bool open();
     bool close();
+    /*!
+     * The data is played in PortAudio callback mode. AudioThread writes to a ring buffer and the callback reads it.
+     * setBufferDuration() sets the ring buffer duration in seconds. default is 0.2s
+     * setDeviceLatency() sets the suggested latency of the device. 0(default) is the device default low latency
+     * They take effect in open()
+     */
+    void setBufferDuration(qreal seconds);
+    qreal bufferDuration() const;
+    void setDeviceLatency(qreal seconds);
+    qreal deviceLatency() const;
+    // times the callback has no enough data since open(). a pause counts once
+    int underruns() const;
+    // samples per channel played since open()
+    qint64 playedSamples() const;
+    // ring buffer data + device latency
+    qreal latency() const;
+    // stops the stream and drops the ring buffer data. write() starts it again
+    void clear();
 
 protected:
     bool write();
@@ -37,6 +37,7 @@ Q_AV_EXPORT QVector<AudioOutputId> GetRegistedAudioOutputIds();
 extern Q_AV_EXPORT AudioOutputId AudioOutputId_PortAudio;
 extern Q_AV_EXPORT AudioOutputId AudioOutputId_OpenAL;
 extern Q_AV_EXPORT AudioOutputId AudioOutputId_OpenSL;
+extern Q_AV_EXPORT AudioOutputId AudioOutputId_Null;
 
 
 Q_AV_EXPORT void AudioOutput_RegisterAll();
@@ -0,0 +1,68 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIOTIMESTRETCHER_H
+#define QTAV_AUDIOTIMESTRETCHER_H
+
+#include <QtAV/QtAV_Global.h>
+
+namespace QtAV {
+
+class AudioFormat;
+class AudioFrame;
+class AudioTimeStretcherPrivate;
+/*!
+ * \brief The AudioTimeStretcher class
+ * Streaming WSOLA time-stretch. Changes the tempo without changing the pitch.
+ * Input frames of any length are buffered and the output is produced in fixed hops, so the output of a call
+ * can be empty. Speed can be changed at any time without restarting, the next hop uses the new speed.
+ * When speed goes back to 1.0, the buffered samples are flushed and later frames pass through untouched.
+ * Supports packed float and packed s16.
+ */
+class Q_AV_EXPORT AudioTimeStretcher
+{
+    DPTR_DECLARE_PRIVATE(AudioTimeStretcher)
+public:
+    AudioTimeStretcher();
+    ~AudioTimeStretcher();
+    static bool isSupported(const AudioFormat& format);
+    // speed > 0. 1.0: normal speed
+    void setSpeed(qreal speed);
+    qreal speed() const;
+    // speed is not 1.0 or samples are buffered
+    bool isActive() const;
+    /*!
+     * \brief process
+     * \return the stretched samples in the same format as frame. Unsupported formats are returned unchanged
+     */
+    AudioFrame process(const AudioFrame& frame);
+    // media time of the input samples buffered but not output yet, in seconds
+    qreal pendingDuration() const;
+    // drop the buffered samples, e.g. after seek
+    void reset();
+
+private:
+    DPTR_DECLARE(AudioTimeStretcher)
+};
+
+} //namespace QtAV
+
+#endif // QTAV_AUDIOTIMESTRETCHER_H
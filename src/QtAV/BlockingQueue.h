@@ -25,6 +25,7 @@
 
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QWaitCondition>
+#include <QtAV/Logging.h>
 
 //TODO: block full and empty condition separately
 template<typename T> class QQueue;
@@ -89,7 +90,7 @@ BlockingQueue<T, Container>::BlockingQueue()
 template <typename T, template <typename> class Container>
 void BlockingQueue<T, Container>::setCapacity(int max)
 {
-    qDebug("queue capacity==>>%d", max);
+    QTAV_DEBUG(LogCore, "queue capacity==>>%d", max);
     QWriteLocker locker(&lock);
     Q_UNUSED(locker);
     cap = max;
@@ -98,7 +99,7 @@ void BlockingQueue<T, Container>::setCapacity(int max)
 template <typename T, template <typename> class Container>
 void BlockingQueue<T, Container>::setThreshold(int min)
 {
-    qDebug("queue threshold==>>%d", min);
+    QTAV_DEBUG(LogCore, "queue threshold==>>%d", min);
     QWriteLocker locker(&lock);
     Q_UNUSED(locker);
     thres = min;
@@ -138,7 +139,7 @@ T BlockingQueue<T, Container>::take()
     }
     //TODO: Why still empty?
     if (queue.isEmpty()) {
-        qWarning("Queue is still empty");
+        QTAV_WARNING_LIMITED(LogCore, "Queue is still empty");
         if (empty_callback) {
             empty_callback->call();
         }
@@ -29,6 +29,17 @@
 // TODO: plane=>channel
 namespace QtAV {
 
+/*!
+ * \brief The FrameBufferRef class
+ * Keeps memory not owned by the frame alive, e.g. a refcounted frame of the decoder. Released with the last
+ * copy of the frame
+ */
+class Q_AV_EXPORT FrameBufferRef : public QSharedData
+{
+public:
+    virtual ~FrameBufferRef() {}
+};
+
 class FramePrivate;
 class Q_AV_EXPORT Frame
 {
@@ -52,6 +63,14 @@ public:
     virtual int bytesPerLine(int plane = 0) const;
     // the whole frame data
     QByteArray frameData() const;
+    // the frame takes the ownership of ref. the planes set by setBits() are valid as long as the frame
+    void setBufferRef(FrameBufferRef *ref);
+    /*!
+     * \brief isBufferOwned
+     * true if the planes are in frameData() or kept by a buffer ref, i.e. not overwritten by the next decode,
+     * and the frame can be kept without clone()
+     */
+    bool isBufferOwned() const;
     // deep copy 1 plane data
     QByteArray data(int plane = 0) const;
     uchar* bits(int plane = 0);
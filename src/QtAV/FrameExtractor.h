@@ -0,0 +1,103 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_FRAMEEXTRACTOR_H
+#define QTAV_FRAMEEXTRACTOR_H
+
+#include <QtCore/QList>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+#include <QtGui/QImage>
+#include <QtAV/QtAV_Global.h>
+#include <QtAV/VideoFrame.h>
+
+namespace QtAV {
+
+class FrameExtractorPrivate;
+/*!
+ * \brief The FrameExtractor class
+ * Extract scaled frames from files without a player, e.g. thumbnails and filmstrips.
+ * Seeks go to the key frame at or before the position and only that key frame is decoded unless
+ * setKeyFrameOnly(false). The decoder decodes at a lower resolution if the output is small enough,
+ * and the pixel format is converted and scaled in one step.
+ * Each worker has its own demuxer, decoder and converter, which are reused for the next file.
+ * extractAsync() extracts files in parallel in WorkerPool's background pool, one file per task.
+ */
+class Q_AV_EXPORT FrameExtractor
+{
+    DPTR_DECLARE_PRIVATE(FrameExtractor)
+    Q_DISABLE_COPY(FrameExtractor)
+public:
+    struct Result {
+        Result() : index(-1), position(0), pts(0), last(false) {}
+        QImage toImage() const; // a copy. null if format is not an image format
+        QString file;
+        int index; // index of the requested position. -1 if the file can not be opened
+        qint64 position; // ms. requested position
+        qint64 pts; // ms. position of the frame
+        VideoFrame frame; // invalid if failed
+        bool last; // the last result of the file
+    };
+    // called in the thread extracting the file
+    typedef void (*ResultCallback)(const Result& result, void *opaque);
+
+    FrameExtractor();
+    ~FrameExtractor();
+    // default is Format_RGB32
+    void setPixelFormat(VideoFormat::PixelFormat format);
+    VideoFormat::PixelFormat pixelFormat() const;
+    /*!
+     * \brief setSize
+     * The frames are scaled to fit in size and the aspect ratio is kept. Default is 160x160.
+     * Invalid size: the size of the video
+     */
+    void setSize(const QSize& size);
+    QSize size() const;
+    /*!
+     * \brief setKeyFrameOnly
+     * true(default): the key frame at or before the position. fast.
+     * false: decode from the key frame to the frame at the position
+     */
+    void setKeyFrameOnly(bool k);
+    bool isKeyFrameOnly() const;
+    // decode at 1/2, 1/4... size if the decoded frame is still not smaller than the output. default is true
+    void setLowResolution(bool lowres);
+    bool isLowResolution() const;
+
+    // extract in the calling thread. positions: ms
+    QList<Result> extract(const QString& file, const QList<qint64>& positions);
+    // count evenly spaced key frames. a key frame is not returned twice, so the result may be less than count
+    QList<Result> extractKeyFrames(const QString& file, int count);
+    // extract each file in WorkerPool. callback is called for each result
+    void extractAsync(const QStringList& files, const QList<qint64>& positions, ResultCallback callback, void *opaque = 0);
+    void extractKeyFramesAsync(const QStringList& files, int count, ResultCallback callback, void *opaque = 0);
+    // files not started are skipped. the files being extracted stop at the next position
+    void cancel();
+    void waitForDone();
+    // number of files not finished
+    int pending() const;
+
+private:
+    DPTR_DECLARE(FrameExtractor)
+};
+
+} //namespace QtAV
+#endif // QTAV_FRAMEEXTRACTOR_H
@@ -37,6 +37,10 @@ public:
     GLWidgetRenderer(QWidget* parent = 0, const QGLWidget* shareWidget = 0, Qt::WindowFlags f = 0);
     virtual VideoRendererId id() const;
     virtual QWidget* widget() { return this; }
+    virtual VideoFormat::PixelFormat preferredPixelFormat() const;
+    virtual bool isSupported(VideoFormat::PixelFormat pixfmt) const;
+    // brightness, contrast and saturation are applied in shaders if GLSL is available
+    virtual bool isEQSupported() const;
 
 protected:
     virtual bool receiveFrame(const VideoFrame& frame);
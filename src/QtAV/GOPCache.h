@@ -0,0 +1,99 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_GOPCACHE_H
+#define QTAV_GOPCACHE_H
+
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+#include <QtAV/QtAV_Global.h>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/VideoFrame.h>
+
+namespace QtAV {
+
+class VideoDecoder;
+/*!
+ * \brief The GOPCache class
+ * Decoded groups of pictures for reverse playback and stepping backward.
+ * A GOP is decoded from its key frame to the next key frame with a private demuxer and decoder,
+ * so the playback pipeline is not disturbed. Frames are implicitly shared and kept until the
+ * memory budget is exceeded. Then the GOPs farthest from the last requested position are dropped.
+ * The GOP before the requested one is decoded in WorkerPool in advance.
+ */
+class Q_AV_EXPORT GOPCache
+{
+public:
+    GOPCache();
+    ~GOPCache();
+    // local files only
+    bool open(const QString& fileName);
+    void close();
+    bool isOpen() const;
+    // bytes. default is 256MB. at least 1 GOP is cached
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    qint64 memoryUsage() const;
+    /*!
+     * \brief frameBefore
+     * \param pts seconds
+     * \param framePts the pts of returned frame
+     * \return the last frame displayed before pts. invalid if pts is at the beginning
+     */
+    VideoFrame frameBefore(qreal pts, qreal *framePts = 0);
+
+private:
+    struct GOP {
+        GOP() : start(0), end(0), bytes(0) {}
+        qreal start; //the key frame packet
+        qreal end; //the next key frame packet
+        QVector<qreal> pts; //ascending
+        QList<VideoFrame> frames;
+        qint64 bytes;
+    };
+    class PrefetchTask;
+    typedef QMap<qreal, GOP> GOPMap;
+    // requires mutex
+    GOPMap::const_iterator findGOP(qreal pts) const;
+    // requires decode_mutex
+    bool decodeGOP(qreal pts, GOP *gop);
+    // decode and insert the GOP for pts if not cached. return false if decode failed
+    bool load(qreal pts);
+    void prefetch(qreal pts);
+    void evict(qreal pts);
+
+    qint64 budget;
+    qint64 usage;
+    AVDemuxer demuxer;
+    VideoDecoder *decoder;
+    GOPMap gops;
+    qreal head; //start of the 1st GOP if known. nothing to prefetch before it
+    qreal tick; //seconds. time base of the video stream, at least 1ms
+    mutable QMutex mutex; //gops, usage
+    QMutex decode_mutex; //demuxer, decoder
+    QWaitCondition prefetch_cond;
+    int prefetching;
+};
+
+} //namespace QtAV
+#endif // QTAV_GOPCACHE_H
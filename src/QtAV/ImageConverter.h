@@ -54,6 +54,14 @@ public:
     void setOutFormat(const VideoFormat& format);
     void setOutFormat(VideoFormat::PixelFormat format);
     void setOutFormat(int formate);
+    /*!
+     * FFmpeg's AVColorSpace and AVColorRange of input. Output range is full for RGB, otherwise
+     * the same as input. If value changes, setup sws
+     */
+    void setInColorSpace(int cs);
+    int inColorSpace() const;
+    void setInRange(int range);
+    int inRange() const;
     void setInterlaced(bool interlaced);
     bool isInterlaced() const;
     /*!
@@ -76,6 +84,9 @@ protected:
     //Allocate memory for out data. Called in setOutFormat()
     virtual bool setupColorspaceDetails();
     virtual bool prepareData(); //Allocate memory for out data
+    // frames may still hold outData() of the previous convert(), e.g. in renderers. then write to a buffer
+    // released by them or a new one
+    void detachOutData();
     DPTR_DECLARE(ImageConverter)
 };
 
@@ -0,0 +1,127 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_LOGGING_H
+#define QTAV_LOGGING_H
+
+#include <QtAV/QtAV_Global.h>
+#include <QtCore/QAtomicInt>
+
+/*!
+ * Leveled logging for the playback pipeline. Messages still go to qDebug()/qWarning(), so a
+ * message handler installed by the application works as before.
+ * Compile time: define QTAV_LOG_LEVEL to 0 (nothing), 1 (warnings) or 2 (all, default). Messages
+ * above the level are removed and their arguments are not evaluated.
+ * Runtime: setLogLevel() for all or one category, or the environment variable QTAV_LOG, e.g.
+ * QTAV_LOG=warning or QTAV_LOG=debug,demux=warning,audio=off
+ * A disabled message is an inline compare. The _LIMITED macros are for messages which may occur
+ * on every packet or frame, at most logRateLimit() of them are printed each second by a call site.
+ */
+#ifndef QTAV_LOG_LEVEL
+#ifdef QT_NO_DEBUG_OUTPUT
+#define QTAV_LOG_LEVEL 1
+#else
+#define QTAV_LOG_LEVEL 2
+#endif
+#endif //QTAV_LOG_LEVEL
+
+namespace QtAV {
+
+enum LogLevel {
+    LogOff = 0,
+    LogWarning = 1,
+    LogDebug = 2
+};
+
+enum LogCategory {
+    LogCore,
+    LogDemux,
+    LogDecoder,
+    LogAudio,
+    LogVideo,
+    LogOutput,
+    LogCategoryCount
+};
+
+namespace Internal {
+extern Q_AV_EXPORT int log_level[LogCategoryCount];
+} //namespace Internal
+
+inline bool isLogEnabled(LogLevel level, LogCategory category) {
+    return level <= Internal::log_level[category];
+}
+// LogCategoryCount: all categories
+Q_AV_EXPORT void setLogLevel(LogLevel level, LogCategory category = LogCategoryCount);
+Q_AV_EXPORT LogLevel logLevel(LogCategory category);
+// messages each second for a _LIMITED call site. default is 5. 0: no limit
+Q_AV_EXPORT void setLogRateLimit(int perSecond);
+Q_AV_EXPORT int logRateLimit();
+
+// state of a rate limited call site. must be statically initialized with QTAV_LOG_LIMITER_INITIALIZER
+struct LogLimiter {
+    QBasicAtomicInt second;
+    QBasicAtomicInt count;
+    QBasicAtomicInt suppressed;
+};
+#define QTAV_LOG_LIMITER_INITIALIZER { Q_BASIC_ATOMIC_INITIALIZER(0), Q_BASIC_ATOMIC_INITIALIZER(0), Q_BASIC_ATOMIC_INITIALIZER(0) }
+
+Q_AV_EXPORT void logMessage(LogLevel level, const char *fmt, ...)
+#if defined(Q_CC_GNU) && !defined(Q_CC_RVCT)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+Q_AV_EXPORT void logMessageLimited(LogLimiter *limiter, LogLevel level, const char *fmt, ...)
+#if defined(Q_CC_GNU) && !defined(Q_CC_RVCT)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+} //namespace QtAV
+
+#define QTAV_LOG(level, category, ...) \
+    do { \
+        if (QtAV::isLogEnabled(level, category)) \
+            QtAV::logMessage(level, __VA_ARGS__); \
+    } while (0)
+#define QTAV_LOG_LIMITED(level, category, ...) \
+    do { \
+        if (QtAV::isLogEnabled(level, category)) { \
+            static QtAV::LogLimiter limiter = QTAV_LOG_LIMITER_INITIALIZER; \
+            QtAV::logMessageLimited(&limiter, level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if QTAV_LOG_LEVEL >= 1
+#define QTAV_WARNING(category, ...) QTAV_LOG(QtAV::LogWarning, QtAV::category, __VA_ARGS__)
+#define QTAV_WARNING_LIMITED(category, ...) QTAV_LOG_LIMITED(QtAV::LogWarning, QtAV::category, __VA_ARGS__)
+#else
+#define QTAV_WARNING(category, ...) do {} while (0)
+#define QTAV_WARNING_LIMITED(category, ...) do {} while (0)
+#endif
+#if QTAV_LOG_LEVEL >= 2
+#define QTAV_DEBUG(category, ...) QTAV_LOG(QtAV::LogDebug, QtAV::category, __VA_ARGS__)
+#define QTAV_DEBUG_LIMITED(category, ...) QTAV_LOG_LIMITED(QtAV::LogDebug, QtAV::category, __VA_ARGS__)
+#else
+#define QTAV_DEBUG(category, ...) do {} while (0)
+#define QTAV_DEBUG_LIMITED(category, ...) do {} while (0)
+#endif
+
+#endif // QTAV_LOGGING_H
@@ -23,6 +23,7 @@
 #define QTAV_OUTPUTSET_H
 
 #include <QtCore/QObject>
+#include <QtCore/QHash>
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
 #include <QtAV/QtAV_Global.h>
@@ -31,6 +32,7 @@
 namespace QtAV {
 
 class AVPlayer;
+class ImageConverter;
 class VideoFrame;
 class Q_AV_EXPORT OutputSet : public QObject
 {
@@ -50,6 +52,13 @@ public:
     //each(OutputOperation(data))
     //
     void sendData(const QByteArray& data);
+    /*!
+     * \brief sendVideoFrame
+     *  Outputs are grouped by the target format and size they request. Each distinct target
+     *  is converted only once (groups are converted in parallel) and the shared result is sent
+     *  to every output in that group. Outputs supporting the frame's format receive it as is.
+     *  Conversions run in WorkerPool with the player's workerPriority().
+     */
     void sendVideoFrame(const VideoFrame& frame);
 
     void clearOutputs();
@@ -77,6 +86,8 @@ private:
     QList<AVOutput*> mOutputs;
     QMutex mMutex;
     QWaitCondition mCond; //pause
+    // converter for each (format, size) target. reused to keep the scale context cached
+    QHash<quint64, ImageConverter*> mConverters;
 };
 
 } //namespace QtAV
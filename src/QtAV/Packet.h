@@ -42,8 +42,10 @@ public:
 
     bool hasKeyFrame;
     bool isCorrupt;
+    bool drain; // output the picture at once and restart the decoder, e.g. a single key frame in trick-play
     QByteArray data;
     qreal pts, duration;
+    qint64 read_time; //us of Statistics::timestamp() when read by demux thread. 0: unknown
 private:
     static const qreal kEndPts;
 };
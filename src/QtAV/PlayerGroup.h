@@ -0,0 +1,110 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_PLAYERGROUP_H
+#define QTAV_PLAYERGROUP_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtAV/QtAV_Global.h>
+
+namespace QtAV {
+
+class AVClock;
+class AVPlayer;
+/*!
+ * \brief The PlayerGroup class
+ * Plays several players synchronously, e.g. the tiles of a video wall.
+ * The group owns a master clock. Each player's clock is an external clock following the master.
+ * Start, pause, seek and speed changes are applied to all players together.
+ * A player whose video falls behind or runs ahead of the others (the pts of the presented frames) is
+ * corrected by adjusting its clock's speed slightly instead of jumping, so frames are not dropped or
+ * repeated visibly. Only a clock more than jumpThreshold() away from the master (e.g. after a stall)
+ * is set directly.
+ * Audio of the players is not resampled by the rate adjustment. Mute all but one player.
+ */
+class Q_AV_EXPORT PlayerGroup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PlayerGroup(QObject *parent = 0);
+    virtual ~PlayerGroup();
+    AVClock* masterClock();
+    // the player's clock is set to external clock. the player is not owned by the group
+    void addPlayer(AVPlayer *player);
+    void removePlayer(AVPlayer *player);
+    QList<AVPlayer*> players() const;
+    // ms. default is 200
+    void setSyncInterval(int ms);
+    int syncInterval() const;
+    /*!
+     * \brief setMaxRateAdjustment
+     * max relative speed change used to correct the drift. default is 0.05, i.e. speed*[0.95, 1.05]
+     */
+    void setMaxRateAdjustment(qreal r);
+    qreal maxRateAdjustment() const;
+    // seconds. default is 0.5
+    void setJumpThreshold(qreal s);
+    qreal jumpThreshold() const;
+    // seconds. the max drift of a player's video from the group measured in the last sync
+    qreal drift() const;
+    qreal speed() const;
+
+public slots:
+    void play(const QString& file);
+    // play the files loaded
+    void play();
+    void stop();
+    void pause(bool p);
+    void togglePause();
+    void seek(qint64 pos); //ms
+    void setSpeed(qreal speed);
+    void playNextFrame();
+
+signals:
+    void paused(bool p);
+
+protected:
+    virtual void timerEvent(QTimerEvent *e);
+
+private slots:
+    void removeDestroyedPlayer(QObject *obj);
+
+private:
+    void sync(bool jump);
+    void startSync();
+    void stopSync();
+
+    AVClock *clock;
+    QList<AVPlayer*> group;
+    QHash<AVPlayer*, qreal> lag; //smoothed video pts - master clock
+    int timer_id;
+    int interval;
+    qreal max_rate;
+    qreal jump_threshold;
+    qreal max_drift;
+    qreal base_speed;
+    bool resync; //players' clocks are set directly in the next sync
+};
+
+} //namespace QtAV
+#endif // QTAV_PLAYERGROUP_H
@@ -31,16 +31,23 @@
 #include <QtAV/AVDemuxer.h>
 #include <QtAV/AVOutput.h>
 #include <QtAV/AVPlayer.h>
+#include <QtAV/Logging.h>
 #include <QtAV/OutputSet.h>
+#include <QtAV/FrameExtractor.h>
 #include <QtAV/Packet.h>
+#include <QtAV/PlayerGroup.h>
 #include <QtAV/Statistics.h>
+#include <QtAV/Tracer.h>
+#include <QtAV/WorkerPool.h>
 
 #include <QtAV/AudioDecoder.h>
+#include <QtAV/AudioFilter.h>
 #include <QtAV/AudioFormat.h>
 #include <QtAV/AudioOutput.h>
 #include <QtAV/AudioOutputTypes.h>
 #include <QtAV/AudioResampler.h>
 #include <QtAV/AudioResamplerTypes.h>
+#include <QtAV/AudioTimeStretcher.h>
 
 #include <QtAV/Filter.h>
 #include <QtAV/FilterContext.h>
@@ -56,6 +63,7 @@
 #include <QtAV/VideoFormat.h>
 #include <QtAV/VideoFrame.h>
 #include <QtAV/VideoRenderer.h>
+#include <QtAV/VideoRendererNull.h>
 #include <QtAV/VideoRendererTypes.h>
 //The following renderer headers can be removed
 #include <QtAV/Direct2DRenderer.h>
@@ -275,4 +275,13 @@ const AVPixFmtDescriptor *av_pix_fmt_desc_get(AVPixelFormat pix_fmt);
 int av_pix_fmt_count_planes(AVPixelFormat pix_fmt);
 #endif //AV_VERSION_INT(52, 38, 100)
 
+/*
+ * refcounted decoded frames: AVCodecContext.refcounted_frames (lavc 55.0.100) and av_frame_clone() (lavu 52.8.100)
+ * FFmpeg >= 2.0
+ */
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55, 0, 100) && LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(52, 8, 100)
+#include <libavutil/frame.h>
+#define QTAV_HAVE_AVFRAME_REF 1
+#endif //AV_VERSION_INT(55, 0, 100)
+
 #endif //QTAV_COMPAT_H
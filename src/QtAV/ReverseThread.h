@@ -0,0 +1,90 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_REVERSETHREAD_H
+#define QTAV_REVERSETHREAD_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QtAV/GOPCache.h>
+
+namespace QtAV {
+
+class AVClock;
+class ImageConverter;
+class OutputSet;
+/*!
+ * \brief The ReverseThread class
+ * Presents frames from a GOPCache backwards. The clock runs at a negative speed and each frame
+ * is sent to outputs when the clock reaches its pts. Pausing the clock pauses the thread.
+ * Call interruptWait() after changing the clock, so the thread waits for the new time at once.
+ * Decoding a GOP may take long, so stepping is also done in the thread.
+ */
+class ReverseThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit ReverseThread(QObject *parent = 0);
+    virtual ~ReverseThread();
+    GOPCache* cache();
+    void setClock(AVClock *clock);
+    void setOutputSet(OutputSet *outputs);
+    void setEQ(int b, int c, int s);
+    /*!
+     * \brief step
+     * show the frame before pts(s) in the thread and emit stepped(). nothing is emitted if no frame before pts
+     * \return false if the thread is running
+     */
+    bool step(qreal pts);
+    bool isStepping() const;
+    void stop();
+    // wake up the thread waiting for the clock
+    void interruptWait();
+
+signals:
+    // no frame before the clock value
+    void reachedStart();
+    // pts(s) of the frame shown by step()
+    void stepped(qreal pts);
+
+protected:
+    virtual void run();
+
+private:
+    void present(const VideoFrame& frame);
+    // false if stopped or interrupted
+    bool waitFor(int ms);
+
+    volatile bool stopped;
+    qreal step_pts; //>= 0: run() shows 1 frame before it
+    volatile bool step_running;
+    QMutex wait_mutex;
+    QWaitCondition wait_cond;
+    bool wait_interrupted;
+    AVClock *clock;
+    OutputSet *outputs;
+    ImageConverter *conv; //carries EQ to outputs
+    GOPCache gop_cache;
+};
+
+} //namespace QtAV
+#endif // QTAV_REVERSETHREAD_H
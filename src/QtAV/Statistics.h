@@ -29,7 +29,7 @@
 
 /*
  * time unit is s
- * TODO: frame counter, frame droped. see VLC
+ * frame counters and stage latency: Statistics::Pipeline
  */
 
 /*!
@@ -117,6 +117,8 @@ public:
         qreal fps;
         // average fps frame AVStream
         qreal avg_frame_rate; //AVStream.avg_frame_rate Kps
+        // clock value - pts when the last frame is sent to renderers. negative if early
+        qreal lateness;
 
         int width, height;
         /**
@@ -143,6 +145,65 @@ public:
         };
         QExplicitlySharedDataPointer<Private> d;
     } video_only;
+
+    /*!
+     * \brief The Pipeline class
+     * Where the time of a stream goes. Each stage is the time between 2 boundaries of a packet/frame:
+     * read -> enqueue -> dequeue -> decoded -> filtered -> converted -> rendered.
+     * Durations are recorded by the demux, decoding and output threads into per stage histograms.
+     * Recording is lock free, so it is always enabled. Call snapshot() to read the values.
+     */
+    class Q_AV_EXPORT Pipeline {
+    public:
+        enum Stage {
+            Read,       // reading a packet from the demuxer
+            Queue,      // read until dequeued by the decoding thread, including the time blocked by a full queue
+            Decode,
+            Filter,
+            Convert,    // video: converting to the formats the renderers require
+            Render,     // sent to outputs until they returned
+            Total,      // read until rendered
+            StageCount
+        };
+        class Q_AV_EXPORT Latency {
+        public:
+            Latency();
+            qint64 count;
+            // us. percentiles are the upper bound of the histogram bucket, i.e. 25% precision
+            qint64 p50, p95, p99, max;
+        };
+        class Q_AV_EXPORT Snapshot {
+        public:
+            Snapshot();
+            Latency stage[StageCount];
+            int queue_depth; // packets in queue when the last one is dequeued
+            int max_queue_depth;
+            qint64 dropped; // decoded but not rendered because of late
+            qint64 late;    // rendered later than the sync threshold
+            qint64 skipped; // packets not decoded, e.g. waiting for a key frame
+        };
+        Pipeline();
+        // Private is defined in cpp
+        Pipeline(const Pipeline& other);
+        ~Pipeline();
+        Pipeline& operator=(const Pipeline& other);
+        // us, from timestamp()
+        void addLatency(Stage stage, qint64 us);
+        void setQueueDepth(int packets);
+        void addDropped();
+        void addLate();
+        void addSkipped();
+        void reset();
+        Snapshot snapshot() const;
+    private:
+        class Private;
+        QExplicitlySharedDataPointer<Private> d;
+    } audio_pipeline, video_pipeline;
+    /*!
+     * \brief timestamp
+     * us of a monotonic clock shared by all threads. used to mark stage boundaries, e.g. Packet::read_time
+     */
+    static qint64 timestamp();
 };
 
 } //namespace QtAV
@@ -0,0 +1,97 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_TRACER_H
+#define QTAV_TRACER_H
+
+#include <QtAV/QtAV_Global.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+namespace QtAV {
+
+/*!
+ * \brief The Tracer class
+ * Opt-in tracing of individual frames through the pipeline. Spans of reading, decoding, filtering,
+ * converting and painting are recorded with thread id and pts, and can be dumped as Chrome trace
+ * event json, which is opened by chrome://tracing or Perfetto.
+ * Each thread writes to its own preallocated ring, no lock and no allocation while recording.
+ * Disabled by default. A disabled probe is a load and a branch.
+ * \code
+ *   Tracer::setEnabled(true);
+ *   ...
+ *   Tracer::dump("trace.json");
+ * \endcode
+ */
+class Q_AV_EXPORT Tracer
+{
+public:
+    class Scope
+    {
+    public:
+        // name and category must be string literals. pts < 0: unknown
+        Scope(const char *name, const char *category, qreal pts = -1)
+            : mName(name)
+            , mCategory(category)
+            , mPts(pts)
+            , mBegin(-1)
+        {
+            if (Tracer::isEnabled())
+                mBegin = Tracer::now();
+        }
+        ~Scope() {
+            if (mBegin >= 0)
+                Tracer::record(mName, mCategory, mBegin, Tracer::now(), mPts);
+        }
+        // pts is known after the span begins, e.g. reading a packet
+        void setPts(qreal pts) { mPts = pts; }
+    private:
+        Q_DISABLE_COPY(Scope)
+        const char *mName;
+        const char *mCategory;
+        qreal mPts;
+        qint64 mBegin;
+    };
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+    /*!
+     * \brief setBufferSize
+     * Max events kept for each thread. Older events are overwritten. Applies to threads that
+     * record the first event after the call. Default is 16384.
+     */
+    static void setBufferSize(int events);
+    static int bufferSize();
+    // discard recorded events
+    static void clear();
+    // Chrome trace event format. Threads are still recording, so pause or disable first for a consistent trace
+    static QByteArray toJson();
+    static bool dump(const QString& fileName);
+    // time in us, the same as Statistics::timestamp()
+    static qint64 now();
+    static void record(const char *name, const char *category, qint64 begin, qint64 end, qreal pts = -1);
+
+private:
+    static bool enabled;
+};
+
+} //namespace QtAV
+#endif // QTAV_TRACER_H
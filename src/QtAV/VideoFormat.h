@@ -71,6 +71,20 @@ public:
         Format_IMC4,
         Format_Y8,
         Format_Y16,
+        Format_YUV422P,
+        // high bit depth planar yuv. LE: little endian, BE: big endian
+        Format_YUV420P10LE,
+        Format_YUV420P10BE,
+        Format_YUV422P10LE,
+        Format_YUV422P10BE,
+        Format_YUV444P10LE,
+        Format_YUV444P10BE,
+        Format_YUV420P16LE,
+        Format_YUV420P16BE,
+        Format_YUV422P16LE,
+        Format_YUV422P16BE,
+        Format_YUV444P16LE,
+        Format_YUV444P16BE,
 
         Format_Jpeg,
 
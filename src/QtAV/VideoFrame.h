@@ -83,6 +83,15 @@ public:
     //use ptr instead of ImageConverterId to avoid allocating memory
     // Id can be used in VideoThread
     void setImageConverter(ImageConverter *conv);
+    ImageConverter* imageConverter() const;
+    /*!
+     * FFmpeg's AVColorSpace and AVColorRange of the decoded frame. Used to choose the yuv => rgb
+     * matrix and levels. Default is unspecified
+     */
+    void setColorSpace(int cs);
+    int colorSpace() const;
+    void setColorRange(int range);
+    int colorRange() const;
     // if use gpu to convert, mapToDevice() first
     bool convertTo(const VideoFormat& fmt);
     bool convertTo(VideoFormat::PixelFormat fmt);
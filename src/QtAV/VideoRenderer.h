@@ -84,6 +84,33 @@ public:
     VideoFormat& videoFormat();
     const VideoFormat& videoFormat() const;
     const VideoFormat& defaultVideoFormat() const;
+    /*!
+     * \brief preferredPixelFormat
+     *  a frame is converted to this format if the renderer does not support the frame's format.
+     *  Outputs in the same OutputSet preferring the same format share one converted frame.
+     *  Default is VideoFormat::Format_RGB32
+     */
+    virtual VideoFormat::PixelFormat preferredPixelFormat() const;
+    /*!
+     * \brief isSupported
+     *  whether the renderer can draw a frame with the given format directly.
+     *  Default is true only for preferredPixelFormat()
+     */
+    virtual bool isSupported(VideoFormat::PixelFormat pixfmt) const;
+    /*!
+     * \brief isEQSupported
+     *  whether brightness, contrast and saturation can be applied by the renderer itself, e.g. in shaders.
+     *  If false(default), the frame is adjusted by the image converter before it is sent to the renderer
+     */
+    virtual bool isEQSupported() const;
+    /*!
+     * brightness, contrast, saturation: -100~100
+     * Set by OutputSet with the player's values if isEQSupported()
+     */
+    void setEQ(int brightness, int contrast, int saturation);
+    int brightness() const;
+    int contrast() const;
+    int saturation() const;
 
     //for testing performance
     void scaleInRenderer(bool q);
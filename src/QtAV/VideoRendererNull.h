@@ -0,0 +1,86 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_VIDEORENDERERNULL_H
+#define QTAV_VIDEORENDERERNULL_H
+
+#include <QtAV/VideoRenderer.h>
+
+namespace QtAV {
+
+/*!
+ * \brief The VideoRendererNull class
+ * A renderer without widget, scene or painting, for headless servers, analysis and benchmarks.
+ * Frames are counted, and optionally passed to a callback or queued for another thread.
+ * Frames are accepted in the decoded format, so no conversion is done unless setPixelFormat() is called.
+ * It never waits for display. To process frames faster than realtime, disable the player's clock pacing.
+ */
+class VideoRendererNullPrivate;
+class Q_AV_EXPORT VideoRendererNull : public VideoRenderer
+{
+    DPTR_DECLARE_PRIVATE(VideoRendererNull)
+public:
+    /*!
+     * Called in the thread sending the frame, usually the video thread. A frame from the player owns its
+     * buffer (see Frame::isBufferOwned()), so it can be kept by copying the VideoFrame without clone().
+     */
+    typedef void (*FrameCallback)(const VideoFrame& frame, void *opaque);
+
+    VideoRendererNull();
+    ~VideoRendererNull();
+    virtual VideoRendererId id() const;
+    /*!
+     * \brief setPixelFormat
+     * Format_Invalid(default): any format is accepted as decoded. Otherwise frames are converted to fmt
+     */
+    void setPixelFormat(VideoFormat::PixelFormat fmt);
+    VideoFormat::PixelFormat pixelFormat() const;
+    virtual VideoFormat::PixelFormat preferredPixelFormat() const;
+    virtual bool isSupported(VideoFormat::PixelFormat pixfmt) const;
+
+    void setFrameCallback(FrameCallback callback, void *opaque = 0);
+    /*!
+     * \brief setQueueSize
+     * Keep the received frames in a lock-free queue of the given size for a consumer thread.
+     * 0(default): no queue. Call it before playing. A frame is dropped if the queue is full.
+     */
+    void setQueueSize(int frames);
+    int queueSize() const;
+    // the oldest queued frame. returns false if the queue is empty. Call it in 1 thread only
+    bool takeFrame(VideoFrame *frame);
+
+    // frames received by this renderer
+    qint64 receivedFrames() const;
+    // frames not delivered because the queue was full, and frames the player decoded but did not render
+    qint64 droppedFrames() const;
+    // frames the player rendered later than the sync threshold
+    qint64 lateFrames() const;
+    void resetCounters();
+
+protected:
+    virtual bool receiveFrame(const VideoFrame& frame);
+    virtual bool needUpdateBackground() const;
+    virtual bool needDrawFrame() const;
+    virtual void drawFrame();
+};
+
+} //namespace QtAV
+#endif // QTAV_VIDEORENDERERNULL_H
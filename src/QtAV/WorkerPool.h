@@ -0,0 +1,92 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_WORKERPOOL_H
+#define QTAV_WORKERPOOL_H
+
+#include <QtAV/QtAV_Global.h>
+
+class QRunnable;
+class QThreadPool;
+namespace QtAV {
+
+class WorkerPoolPrivate;
+/*!
+ * \brief The WorkerPool class
+ * Worker threads and codec threads shared by all players in the process.
+ * Short tasks, e.g. converting frames for renderers, capturing and prefetching, run in one thread pool
+ * instead of each player creating threads. Tasks with higher priority run first.
+ * Decoders request their FFmpeg threads from a global budget when opened, so the number of codec
+ * threads does not grow with the number of players.
+ */
+class Q_AV_EXPORT WorkerPool
+{
+    DPTR_DECLARE_PRIVATE(WorkerPool)
+    Q_DISABLE_COPY(WorkerPool)
+public:
+    static WorkerPool& instance();
+    QThreadPool* threadPool();
+    // the pool takes the ownership if task->autoDelete()
+    void start(QRunnable *task, int priority = 0);
+    // default is QThread::idealThreadCount()
+    void setMaxThreads(int threads);
+    int maxThreads() const;
+    /*!
+     * \brief startBackground
+     * Long tasks, e.g. extracting thumbnails and prefetching GOPs, run in a separate thread pool.
+     * Players wait for the tasks of threadPool(), which must not be blocked by them.
+     */
+    void startBackground(QRunnable *task, int priority = 0);
+    // default is QThread::idealThreadCount()
+    void setMaxBackgroundThreads(int threads);
+    int maxBackgroundThreads() const;
+    /*!
+     * \brief setCodecThreadBudget
+     * Max total codec threads of all opened decoders. Decoders already opened are not changed, so a decoder
+     * gets the share as if 1 more decoder is opened after it: budget/2 for the 1st, budget/3 for the 2nd...
+     * and not more than what is left. A decoder always gets at least 1 thread.
+     * Default is QThread::idealThreadCount(). 0: no limit
+     */
+    void setCodecThreadBudget(int threads);
+    int codecThreadBudget() const;
+    int codecThreadsInUse() const;
+    /*!
+     * \brief reserveDecoders
+     * Expect n more decoders, e.g. the players of a video wall. The budget is shared equally by the decoders
+     * expected while less decoders are opened.
+     * Call releaseDecoders() with the same n when they are not expected anymore
+     */
+    void reserveDecoders(int n);
+    void releaseDecoders(int n);
+    // called when a multithreaded video decoder opens. returns the threads granted
+    int acquireCodecThreads(int wanted);
+    // called when a decoder closes with the value acquireCodecThreads() returned
+    void releaseCodecThreads(int threads);
+
+private:
+    WorkerPool();
+    ~WorkerPool();
+
+    DPTR_DECLARE(WorkerPool)
+};
+
+} //namespace QtAV
+#endif // QTAV_WORKERPOOL_H
@@ -35,6 +35,8 @@ class Q_AV_EXPORT XVRenderer : public QWidget, public VideoRenderer
 public:
     XVRenderer(QWidget* parent = 0, Qt::WindowFlags f = 0);
     virtual VideoRendererId id() const;
+    // YV12 port. OutputSet converts to it once for all xv renderers
+    virtual VideoFormat::PixelFormat preferredPixelFormat() const;
 
     /* WA_PaintOnScreen: To render outside of Qt's paint system, e.g. If you require
      * native painting primitives, you need to reimplement QWidget::paintEngine() to
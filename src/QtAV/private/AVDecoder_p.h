@@ -27,6 +27,7 @@
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include <QtAV/QtAV_Compat.h>
+#include <QtAV/WorkerPool.h>
 
 namespace QtAV {
 
@@ -41,6 +42,7 @@ public:
       , frame(0)
       , got_frame_ptr(0)
       , undecoded_size(0)
+      , codec_threads(0)
       , thread_slice(1)
       , low_resolution(0)
       , dict(0)
@@ -59,6 +61,13 @@ public:
     }
     virtual bool open() {return true;}
     virtual void close() {}
+    // give back the threads acquired in AVDecoder::open()
+    void releaseCodecThreads() {
+        if (!codec_threads)
+            return;
+        WorkerPool::instance().releaseCodecThreads(codec_threads);
+        codec_threads = 0;
+    }
 
     AVCodecContext *codec_ctx; //set once and not change
     bool available;
@@ -70,6 +79,7 @@ public:
     int undecoded_size;
     QMutex mutex;
     int threads;
+    int codec_threads; //acquired from WorkerPool. released when closed
     bool thread_slice;
     int low_resolution;
     QString name;
@@ -25,6 +25,12 @@
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QWaitCondition>
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+#include <QtCore/QElapsedTimer>
+#else
+#include <QtCore/QTime>
+typedef QTime QElapsedTimer;
+#endif
 
 #include <QtAV/Packet.h>
 #include <QtAV/QtAV_Global.h>
@@ -48,6 +54,7 @@ public:
         paused(false)
       , next_pause(false)
       , demux_end(false)
+      , free_run(false)
       , stop(false)
       , clock(0)
       , dec(0)
@@ -56,12 +63,15 @@ public:
       , filter_context(0)
       , statistics(0)
       , ready(false)
+      , wait_interrupted(false)
     {
+        sched_timer.start();
     }
     virtual ~AVThreadPrivate();
 
     bool paused, next_pause;
     bool demux_end;
+    volatile bool free_run;
     volatile bool stop; //true when packets is empty and demux is end.
     AVClock *clock;
     PacketQueue packets;
@@ -77,6 +87,11 @@ public:
     QWaitCondition ready_cond;
     QMutex ready_mutex;
     bool ready;
+    // presentation scheduler. deadlines are in us of sched_timer, which is monotonic
+    QElapsedTimer sched_timer;
+    QMutex wait_mutex;
+    QWaitCondition wait_cond;
+    bool wait_interrupted;
 };
 
 } //namespace QtAV
@@ -0,0 +1,71 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#ifndef QTAV_AUDIODSP_P_H
+#define QTAV_AUDIODSP_P_H
+
+#include <QtAV/QtAV_Global.h>
+
+/*
+ * Sample kernels used by the audio filters and AudioThread.
+ * The best implementation (AVX, SSE2, NEON or C) is selected once at runtime from the cpu flags.
+ * Pointers can be unaligned. count is the number of samples, not bytes or frames.
+ */
+namespace QtAV {
+
+class AudioFrame;
+namespace AudioDSP {
+
+// "avx", "sse2", "neon" or "c"
+Q_AV_EXPORT const char* simdName();
+/*!
+ * use the C implementation only. for testing and benchmarking. not thread safe, call it before playing
+ */
+Q_AV_EXPORT void setSIMDEnabled(bool enabled);
+
+Q_AV_EXPORT void gain(float *data, int count, float g);
+// rounded and saturated
+Q_AV_EXPORT void gain(qint16 *data, int count, float g);
+Q_AV_EXPORT void clip(float *data, int count, float minValue = -1.0f, float maxValue = 1.0f);
+Q_AV_EXPORT void s16ToFloat(const qint16 *src, float *dst, int count);
+// rounded and saturated
+Q_AV_EXPORT void floatToS16(const float *src, qint16 *dst, int count);
+// sum(a[i]*b[i])
+Q_AV_EXPORT float dot(const float *a, const float *b, int count);
+// out[i] = a[i] + (b[i] - a[i])*w[i]. out can be a or b
+Q_AV_EXPORT void crossfade(const float *a, const float *b, const float *w, float *out, int count);
+/*!
+ * \brief mixdown
+ * mix interleaved float frames. out[c] = sum(matrix[c*in_channels + i] * in[i])
+ * \param matrix out_channels x in_channels. 0: average all input channels
+ */
+Q_AV_EXPORT void mixdown(const float *in, int in_channels, float *out, int out_channels, int frames, const float *matrix = 0);
+/*!
+ * apply gain to all planes of a frame in place. supports all sample formats.
+ * float and s16 are vectorized. Integer formats are saturated.
+ * The data is not detached. clone() a frame sharing the data with others, e.g. decoder's buffer
+ */
+Q_AV_EXPORT bool gain(AudioFrame *frame, qreal g);
+
+} //namespace AudioDSP
+} //namespace QtAV
+
+#endif // QTAV_AUDIODSP_P_H
@@ -45,6 +45,7 @@ public:
     int max_channels;
     AudioFormat format;
     QByteArray data;
+    QByteArray packed; //planar frames are interleaved here
 };
 
 } //namespace QtAV
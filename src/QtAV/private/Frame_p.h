@@ -22,7 +22,7 @@
 #ifndef QTAV_FRAME_P_H
 #define QTAV_FRAME_P_H
 
-#include <QtAV/QtAV_Global.h>
+#include <QtAV/Frame.h>
 #include <QtCore/QVector>
 #include <QtCore/QVariant>
 #include <QtCore/QSharedData>
@@ -43,6 +43,7 @@ public:
     QVector<int> line_sizes; //stride
     QVariantMap metadata;
     QByteArray data;
+    QExplicitlySharedDataPointer<FrameBufferRef> buffer_ref;
 };
 
 } //namespace QtAV
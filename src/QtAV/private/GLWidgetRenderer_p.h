@@ -22,10 +22,15 @@
 #ifndef QTAV_GLWIDGETRENDERER_P_H
 #define QTAV_GLWIDGETRENDERER_P_H
 #include <QtOpenGL/qgl.h>
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 #include "private/VideoRenderer_p.h"
 #include <QtAV/VideoFormat.h>
 
+#ifndef APIENTRY
+#define APIENTRY
+#endif //APIENTRY
+
 namespace QtAV {
 
 class Q_AV_EXPORT GLWidgetRendererPrivate : public VideoRendererPrivate, public QGLFunctions
@@ -41,9 +46,17 @@ public:
       , a_Position(0)
       , a_TexCoords(0)
       , u_matrix(0)
+      , u_colorMatrix(0)
       , painter(0)
       , pixel_fmt(VideoFormat::Format_Invalid)
+      , update_color_matrix(true)
+      , pbo_supported(false)
+      , pbo_index(0)
+      , frame_changed(false)
+      , glMapBuffer(0)
+      , glUnmapBuffer(0)
     {
+        memset(&color_key, 0, sizeof(color_key));
         if (QGLFormat::openGLVersionFlags() == QGLFormat::OpenGL_Version_None) {
             available = false;
             return;
@@ -54,11 +67,29 @@ public:
     }
     GLuint loadShader(GLenum shaderType, const char* pSource);
     GLuint createProgram(const char* pVertexSource, const char* pFragmentSource);
+    // delete textures and pbo. programs are cached
+    bool releaseTextures();
     bool releaseResource();
     bool initTexture(GLuint tex, GLint internal_format, GLenum format, int width, int height);
+    /*!
+     * compute textures from the plane descriptors of a yuv format. defines is the sampling code
+     * (SAMPLE_Y, SAMPLE_U, SAMPLE_V) prepended to yuv_rgb.f.glsl
+     */
+    bool setupYUVTextures(const VideoFormat& fmt, int width, int height, QByteArray *defines);
     bool prepareShaderProgram(const VideoFormat& fmt, int width, int height);
+    // set u_colorMatrix if colorspace, range or eq changed. program must be in use
+    void setupColorMatrix();
     void upload(const QRect& roi);
-    void uploadPlane(int p, GLint internal_format, GLenum format, const QRect& roi);
+    void uploadPlane(int tex, GLint internal_format, GLenum format, const QRect& roi);
+    /*!
+     * pixel buffer objects. check extension and resolve functions. called in initializeGL()
+     * Set env QTAV_GL_NO_PBO=1 to use the synchronous upload. Disabled for software rasterizers
+     */
+    bool initPBO(const QGLContext* ctx);
+    // copy a plane of video_frame to pbo[pbo_index]. false if mapping failed
+    bool fillPBO(int tex);
+    // start the transfer from pbo[pbo_index] to the texture
+    void uploadPlanePBO(int tex, GLenum format);
     //GL 4.x: GL_FRAGMENT_SHADER_DERIVATIVE_HINT,GL_TEXTURE_COMPRESSION_HINT
     //GL_DONT_CARE(default), GL_FASTEST, GL_NICEST
     /*
@@ -131,6 +162,10 @@ public:
     bool hasGLSL;
     bool update_texcoords;
     QVector<GLuint> textures;
+    // a texture samples a plane. packed yuv uses 2 textures for 1 plane
+    QVector<int> texture_plane;
+    QVector<QSize> texture_size;
+    QVector<int> texel_bytes;
     QVector<GLint> internal_format;
     QVector<GLenum> data_format;
     GLuint program;
@@ -139,11 +174,38 @@ public:
     GLuint a_TexCoords;
     QVector<GLuint> u_Texture; //u_TextureN
     GLuint u_matrix;
+    GLuint u_colorMatrix;
+    struct ShaderProgram {
+        GLuint program;
+        GLuint a_Position, a_TexCoords;
+        GLuint u_matrix, u_colorMatrix;
+        QVector<GLuint> u_Texture;
+    };
+    // FFmpeg pixel format => program
+    QHash<int, ShaderProgram> programs;
 
     QPainter *painter;
 
     VideoFormat::PixelFormat pixel_fmt;
     QSize texture0Size;
+    // parameters u_colorMatrix is computed from
+    struct {
+        int cs, range, height, brightness, contrast, saturation;
+    } color_key;
+    bool update_color_matrix;
+
+    typedef GLvoid* (APIENTRY *MapBuffer_t)(GLenum target, GLenum access);
+    typedef GLboolean (APIENTRY *UnmapBuffer_t)(GLenum target);
+    bool pbo_supported;
+    /*
+     * 2 pbo for each plane. A new frame is copied to pbo[pbo_index] and uploaded to the textures from it
+     * in the same paint. The next frame uses the other pbo, so mapping does not wait for the transfer in flight
+     */
+    int pbo_index;
+    QVector<GLuint> pbo[2];
+    bool frame_changed; //a new frame is received or the textures are recreated after the last upload
+    MapBuffer_t glMapBuffer;
+    UnmapBuffer_t glUnmapBuffer;
 };
 
 } //namespace QtAV
@@ -25,6 +25,7 @@
 
 #include <QtAV/QtAV_Compat.h>
 #include <QtCore/QByteArray>
+#include <QtCore/QList>
 
 namespace QtAV {
 
@@ -38,6 +39,8 @@ public:
         , w_out(0),h_out(0)
         , fmt_in(PIX_FMT_YUV420P)
         , fmt_out(PIX_FMT_RGB32)
+        , cs_in(AVCOL_SPC_UNSPECIFIED)
+        , range_in(AVCOL_RANGE_UNSPECIFIED)
         , brightness(0)
         , contrast(0)
         , saturation(0)
@@ -45,8 +48,11 @@ public:
     bool interlaced;
     int w_in, h_in, w_out, h_out;
     int fmt_in, fmt_out;
+    int cs_in, range_in;
     int brightness, contrast, saturation;
     QByteArray data_out;
+    // previous outputs. reused by detachOutData() when the renderers release them
+    QList<QByteArray> out_pool;
     AVPicture picture;
 };
 
@@ -35,7 +35,19 @@ public:
     {
     }
     virtual ~VideoDecoderFFmpegPrivate() {
+#if QTAV_HAVE(AVFRAME_REF)
+        // the decoder's reference. frames still in use keep their own
+        if (frame)
+            av_frame_unref(frame);
+#endif //QTAV_HAVE(AVFRAME_REF)
     }
+#if QTAV_HAVE(AVFRAME_REF)
+    // decoded frames are valid until released, so the renderers can keep them without copy
+    virtual bool open() {
+        codec_ctx->refcounted_frames = 1;
+        return true;
+    }
+#endif //QTAV_HAVE(AVFRAME_REF)
 };
 
 } //namespace QtAV
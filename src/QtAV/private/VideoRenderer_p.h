@@ -57,6 +57,9 @@ public:
       , osd_filter(0)
       , subtitle_filter(0)
       , default_event_filter(true)
+      , brightness(0)
+      , contrast(0)
+      , saturation(0)
     {
         //conv.setInFormat(PIX_FMT_YUV420P);
         //conv.setOutFormat(PIX_FMT_BGR32); //TODO: why not RGB32?
@@ -109,6 +112,8 @@ public:
 
     Filter *osd_filter, *subtitle_filter; //should be at the end of list and draw top level
     bool default_event_filter;
+    // -100~100. used if the renderer supports eq
+    int brightness, contrast, saturation;
     VideoFrame video_frame;
 };
 
@@ -0,0 +1,184 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/ReverseThread.h"
+#include "QtAV/AVClock.h"
+#include "QtAV/ImageConverter.h"
+#include "QtAV/ImageConverterTypes.h"
+#include "QtAV/OutputSet.h"
+#include "QtAV/QtAV_Compat.h"
+
+namespace QtAV {
+
+// s. drop the frame if the clock has passed it more than this
+static const qreal kMaxLate = 0.1;
+// ms. the longest wait if the clock is paused or changed without interruptWait()
+static const int kMaxWait = 100;
+
+ReverseThread::ReverseThread(QObject *parent)
+    : QThread(parent)
+    , stopped(false)
+    , step_pts(-1)
+    , step_running(false)
+    , wait_interrupted(false)
+    , clock(0)
+    , outputs(0)
+    , conv(0)
+{
+    conv = ImageConverterFactory::create(ImageConverterId_FF);
+}
+
+ReverseThread::~ReverseThread()
+{
+    stop();
+    wait();
+    if (conv) {
+        delete conv;
+        conv = 0;
+    }
+}
+
+GOPCache* ReverseThread::cache()
+{
+    return &gop_cache;
+}
+
+void ReverseThread::setClock(AVClock *clock)
+{
+    this->clock = clock;
+}
+
+void ReverseThread::setOutputSet(OutputSet *outputs)
+{
+    this->outputs = outputs;
+}
+
+void ReverseThread::setEQ(int b, int c, int s)
+{
+    if (!conv)
+        return;
+    conv->setBrightness(b);
+    conv->setContrast(c);
+    conv->setSaturation(s);
+}
+
+bool ReverseThread::step(qreal pts)
+{
+    if (isRunning())
+        return false;
+    step_pts = qMax<qreal>(0, pts);
+    step_running = true;
+    start();
+    return true;
+}
+
+bool ReverseThread::isStepping() const
+{
+    return isRunning() && step_running;
+}
+
+void ReverseThread::stop()
+{
+    stopped = true;
+    interruptWait();
+}
+
+void ReverseThread::interruptWait()
+{
+    QMutexLocker lock(&wait_mutex);
+    Q_UNUSED(lock);
+    wait_interrupted = true;
+    wait_cond.wakeAll();
+}
+
+bool ReverseThread::waitFor(int ms)
+{
+    QMutexLocker lock(&wait_mutex);
+    Q_UNUSED(lock);
+    if (!wait_interrupted && !stopped)
+        wait_cond.wait(&wait_mutex, (unsigned long)ms);
+    if (wait_interrupted) {
+        wait_interrupted = false;
+        return false;
+    }
+    return !stopped;
+}
+
+void ReverseThread::run()
+{
+    stopped = false;
+    const qreal step_to = step_pts;
+    step_pts = -1;
+    step_running = step_to >= 0;
+    if (!outputs)
+        return;
+    if (step_to >= 0) {
+        qreal frame_pts = -1;
+        VideoFrame frame = gop_cache.frameBefore(step_to, &frame_pts);
+        if (!frame.isValid() || stopped)
+            return;
+        present(frame);
+        emit stepped(frame_pts);
+        return;
+    }
+    if (!clock)
+        return;
+    {
+        QMutexLocker lock(&wait_mutex);
+        Q_UNUSED(lock);
+        wait_interrupted = false;
+    }
+    qreal pts = clock->value();
+    while (!stopped) {
+        qreal frame_pts = -1;
+        VideoFrame frame = gop_cache.frameBefore(pts, &frame_pts);
+        if (!frame.isValid()) {
+            emit reachedStart();
+            break;
+        }
+        pts = frame_pts;
+        // the clock runs backward
+        qreal diff = clock->value() - frame_pts;
+        while (diff > 0 && !stopped) {
+            const qreal speed = qAbs(clock->speed());
+            // the time the clock reaches the frame. woken up by interruptWait() if the clock changes
+            if (!clock->isActive() || speed == 0)
+                waitFor(kMaxWait);
+            else
+                waitFor(qBound<int>(1, int(diff*1000.0/speed), kMaxWait*10));
+            diff = clock->value() - frame_pts;
+        }
+        if (stopped)
+            break;
+        if (diff < -kMaxLate*qMax<qreal>(1.0, qAbs(clock->speed())))
+            continue;
+        present(frame);
+    }
+}
+
+void ReverseThread::present(const VideoFrame &frame)
+{
+    VideoFrame f(frame);
+    f.setImageConverter(conv);
+    outputs->sendVideoFrame(f);
+}
+
+} //namespace QtAV
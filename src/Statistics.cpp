@@ -20,9 +20,53 @@
 ******************************************************************************/
 
 #include "QtAV/Statistics.h"
+#include <QtCore/QAtomicInt>
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+#include <QtCore/QElapsedTimer>
+#else
+#include <QtCore/QTime>
+typedef QTime QElapsedTimer;
+#endif
 
 namespace QtAV {
 
+namespace {
+// started before any thread records a timestamp
+class MonotonicTimer {
+public:
+    MonotonicTimer() { timer.start(); }
+    QElapsedTimer timer;
+};
+static MonotonicTimer sTimer;
+
+// 4 buckets for each power of 2, i.e. 25% precision. the last one is about 2 minutes
+static const int kSubBuckets = 4;
+static const int kBuckets = 27*kSubBuckets;
+
+static int bucketIndex(qint64 us)
+{
+    if (us <= 1)
+        return 0;
+    int msb = 0;
+    for (qint64 v = us; v > 1; v >>= 1)
+        ++msb;
+    int sub = 0;
+    if (msb >= 2)
+        sub = int(us >> (msb - 2)) & (kSubBuckets - 1);
+    return qMin(msb*kSubBuckets + sub, kBuckets - 1);
+}
+
+// the max value in bucket i
+static qint64 bucketBound(int i)
+{
+    const int msb = i/kSubBuckets;
+    const int sub = i%kSubBuckets;
+    if (msb < 2)
+        return (2LL << msb) - 1LL;
+    return ((qint64)(kSubBuckets + sub + 1) << (msb - 2)) - 1LL;
+}
+} //namespace
+
 Statistics::Common::Common():
     available(false)
   , bit_rate(0)
@@ -46,6 +90,7 @@ Statistics::VideoOnly::VideoOnly():
     fps_guess(0)
   , fps(0)
   , avg_frame_rate(0)
+  , lateness(0)
   , width(0)
   , height(0)
   , coded_width(0)
@@ -77,6 +122,145 @@ qreal Statistics::VideoOnly::currentDisplayFPS() const
     return (qreal)d->ptsHistory.size()/(d->ptsHistory.last() - d->ptsHistory.first());
 }
 
+class Statistics::Pipeline::Private : public QSharedData
+{
+public:
+    QAtomicInt buckets[StageCount][kBuckets];
+    QAtomicInt count[StageCount];
+    QAtomicInt max[StageCount]; //us
+    QAtomicInt queue_depth, max_queue_depth;
+    QAtomicInt dropped, late, skipped;
+};
+
+Statistics::Pipeline::Latency::Latency():
+    count(0)
+  , p50(0)
+  , p95(0)
+  , p99(0)
+  , max(0)
+{
+}
+
+Statistics::Pipeline::Snapshot::Snapshot():
+    queue_depth(0)
+  , max_queue_depth(0)
+  , dropped(0)
+  , late(0)
+  , skipped(0)
+{
+}
+
+Statistics::Pipeline::Pipeline():
+    d(new Private())
+{
+}
+
+Statistics::Pipeline::Pipeline(const Pipeline &other):
+    d(other.d)
+{
+}
+
+Statistics::Pipeline::~Pipeline()
+{
+}
+
+Statistics::Pipeline& Statistics::Pipeline::operator=(const Pipeline &other)
+{
+    d = other.d;
+    return *this;
+}
+
+void Statistics::Pipeline::addLatency(Stage stage, qint64 us)
+{
+    if (stage < 0 || stage >= StageCount)
+        return;
+    us = qMax<qint64>(0, us);
+    d->buckets[stage][bucketIndex(us)].fetchAndAddRelaxed(1);
+    d->count[stage].fetchAndAddRelaxed(1);
+    const int v = (int)qMin<qint64>(us, 0x7fffffff);
+    int m = d->max[stage].fetchAndAddRelaxed(0);
+    while (v > m && !d->max[stage].testAndSetRelaxed(m, v))
+        m = d->max[stage].fetchAndAddRelaxed(0);
+}
+
+void Statistics::Pipeline::setQueueDepth(int packets)
+{
+    d->queue_depth.fetchAndStoreRelaxed(packets);
+    int m = d->max_queue_depth.fetchAndAddRelaxed(0);
+    while (packets > m && !d->max_queue_depth.testAndSetRelaxed(m, packets))
+        m = d->max_queue_depth.fetchAndAddRelaxed(0);
+}
+
+void Statistics::Pipeline::addDropped()
+{
+    d->dropped.fetchAndAddRelaxed(1);
+}
+
+void Statistics::Pipeline::addLate()
+{
+    d->late.fetchAndAddRelaxed(1);
+}
+
+void Statistics::Pipeline::addSkipped()
+{
+    d->skipped.fetchAndAddRelaxed(1);
+}
+
+void Statistics::Pipeline::reset()
+{
+    for (int s = 0; s < StageCount; ++s) {
+        for (int i = 0; i < kBuckets; ++i)
+            d->buckets[s][i].fetchAndStoreRelaxed(0);
+        d->count[s].fetchAndStoreRelaxed(0);
+        d->max[s].fetchAndStoreRelaxed(0);
+    }
+    d->queue_depth.fetchAndStoreRelaxed(0);
+    d->max_queue_depth.fetchAndStoreRelaxed(0);
+    d->dropped.fetchAndStoreRelaxed(0);
+    d->late.fetchAndStoreRelaxed(0);
+    d->skipped.fetchAndStoreRelaxed(0);
+}
+
+Statistics::Pipeline::Snapshot Statistics::Pipeline::snapshot() const
+{
+    Snapshot s;
+    for (int st = 0; st < StageCount; ++st) {
+        // counters may change while reading. use the sum of buckets read
+        qint64 hist[kBuckets];
+        qint64 n = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            hist[i] = d->buckets[st][i].fetchAndAddRelaxed(0);
+            n += hist[i];
+        }
+        Latency &l = s.stage[st];
+        l.count = n;
+        l.max = d->max[st].fetchAndAddRelaxed(0);
+        if (n == 0)
+            continue;
+        const qint64 rank50 = (n*50 + 99)/100, rank95 = (n*95 + 99)/100, rank99 = (n*99 + 99)/100;
+        qint64 acc = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            if (!hist[i])
+                continue;
+            const qint64 prev = acc;
+            acc += hist[i];
+            const qint64 bound = qMin(bucketBound(i), l.max);
+            if (prev < rank50 && acc >= rank50)
+                l.p50 = bound;
+            if (prev < rank95 && acc >= rank95)
+                l.p95 = bound;
+            if (prev < rank99 && acc >= rank99)
+                l.p99 = bound;
+        }
+    }
+    s.queue_depth = d->queue_depth.fetchAndAddRelaxed(0);
+    s.max_queue_depth = d->max_queue_depth.fetchAndAddRelaxed(0);
+    s.dropped = d->dropped.fetchAndAddRelaxed(0);
+    s.late = d->late.fetchAndAddRelaxed(0);
+    s.skipped = d->skipped.fetchAndAddRelaxed(0);
+    return s;
+}
+
 Statistics::Statistics()
 {
 }
@@ -92,6 +276,18 @@ void Statistics::reset()
     video = Common();
     audio_only = AudioOnly();
     video_only = VideoOnly();
+    // threads may be recording
+    audio_pipeline.reset();
+    video_pipeline.reset();
+}
+
+qint64 Statistics::timestamp()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+    return sTimer.timer.nsecsElapsed()/1000LL;
+#else
+    return (qint64)sTimer.timer.elapsed()*1000LL;
+#endif
 }
 
 } //namespace QtAV
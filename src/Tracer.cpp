@@ -0,0 +1,228 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/Tracer.h"
+#include "QtAV/Statistics.h"
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
+
+namespace QtAV {
+
+namespace {
+struct Event {
+    const char *name;
+    const char *category;
+    qint64 begin, end; //us
+    qreal pts;
+};
+
+// written by 1 thread only. the reader may see a partially overwritten event if the thread is recording
+class Ring {
+public:
+    Ring(int size, int id)
+        : tid(id)
+        , events(size)
+        , written(0)
+        , in_use(1)
+    {}
+    int tid;
+    QString thread_name;
+    QVector<Event> events;
+    QAtomicInt written;
+    QAtomicInt in_use;
+};
+
+// rings of finished threads are kept until this limit, then reused by new threads
+static const int kMaxRings = 64;
+
+class TraceBuffers {
+public:
+    TraceBuffers() : buffer_size(16384), reused(0) {}
+    // rings are not deleted. the thread storage of the main thread may be cleaned up later
+    Ring* acquire() {
+        QMutexLocker lock(&mutex);
+        Q_UNUSED(lock);
+        QThread *t = QThread::currentThread();
+        QString name = t->objectName();
+        if (name.isEmpty())
+            name = QString::fromLatin1(t->metaObject()->className());
+        Ring *r = 0;
+        if (rings.size() >= kMaxRings) {
+            foreach (Ring *ring, rings) {
+                if (ring->events.size() == buffer_size && ring->in_use.testAndSetOrdered(0, 1)) {
+                    r = ring;
+                    break;
+                }
+            }
+        }
+        if (r) {
+            r->tid = rings.size() + (++reused);
+            r->written.fetchAndStoreOrdered(0);
+        } else {
+            r = new Ring(buffer_size, rings.size() + 1);
+            rings.append(r);
+        }
+        r->thread_name = name;
+        return r;
+    }
+    QMutex mutex;
+    QList<Ring*> rings;
+    int buffer_size;
+    int reused;
+};
+static TraceBuffers sBuffers;
+
+// QThreadStorage deletes the holder when the thread finishes. the events are kept
+class RingHolder {
+public:
+    RingHolder() : ring(sBuffers.acquire()) {}
+    ~RingHolder() { ring->in_use.fetchAndStoreOrdered(0); }
+    Ring *ring;
+};
+static QThreadStorage<RingHolder*> sRing;
+
+static void appendEvent(QByteArray& json, const Event& e, int tid, qint64 pid)
+{
+    json += "{\"name\":\"";
+    json += e.name;
+    json += "\",\"cat\":\"";
+    json += e.category;
+    json += "\",\"ph\":\"X\",\"ts\":";
+    json += QByteArray::number(e.begin);
+    json += ",\"dur\":";
+    json += QByteArray::number(e.end - e.begin);
+    json += ",\"pid\":";
+    json += QByteArray::number(pid);
+    json += ",\"tid\":";
+    json += QByteArray::number(tid);
+    if (e.pts >= 0) {
+        json += ",\"args\":{\"pts\":";
+        json += QByteArray::number(e.pts, 'f', 3);
+        json += "}";
+    }
+    json += "},\n";
+}
+} //namespace
+
+bool Tracer::enabled = false;
+
+void Tracer::setEnabled(bool value)
+{
+    enabled = value;
+}
+
+void Tracer::setBufferSize(int events)
+{
+    QMutexLocker lock(&sBuffers.mutex);
+    Q_UNUSED(lock);
+    sBuffers.buffer_size = qMax(events, 1);
+}
+
+int Tracer::bufferSize()
+{
+    QMutexLocker lock(&sBuffers.mutex);
+    Q_UNUSED(lock);
+    return sBuffers.buffer_size;
+}
+
+void Tracer::clear()
+{
+    QMutexLocker lock(&sBuffers.mutex);
+    Q_UNUSED(lock);
+    foreach (Ring *r, sBuffers.rings) {
+        r->written.fetchAndStoreOrdered(0);
+    }
+}
+
+QByteArray Tracer::toJson()
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    QMutexLocker lock(&sBuffers.mutex);
+    Q_UNUSED(lock);
+    foreach (Ring *r, sBuffers.rings) {
+        const int written = r->written.fetchAndAddAcquire(0);
+        if (written <= 0)
+            continue;
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":";
+        json += QByteArray::number(pid);
+        json += ",\"tid\":";
+        json += QByteArray::number(r->tid);
+        json += ",\"args\":{\"name\":\"";
+        json += r->thread_name.toUtf8();
+        json += "\"}},\n";
+        const int size = r->events.size();
+        // oldest first
+        const int n = qMin(written, size);
+        for (int i = written - n; i < written; ++i) {
+            appendEvent(json, r->events.at(i % size), r->tid, pid);
+        }
+    }
+    if (json.endsWith(",\n"))
+        json.chop(2);
+    json += "\n]}\n";
+    return json;
+}
+
+bool Tracer::dump(const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Tracer: can not open %s: %s", qPrintable(fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    const QByteArray json(toJson());
+    if (f.write(json) != json.size()) {
+        qWarning("Tracer: failed to write %s: %s", qPrintable(fileName), qPrintable(f.errorString()));
+        return false;
+    }
+    return true;
+}
+
+qint64 Tracer::now()
+{
+    return Statistics::timestamp();
+}
+
+void Tracer::record(const char *name, const char *category, qint64 begin, qint64 end, qreal pts)
+{
+    if (!sRing.hasLocalData())
+        sRing.setLocalData(new RingHolder());
+    Ring *r = sRing.localData()->ring;
+    // the only writer. no need to be atomic
+    const int i = r->written.fetchAndAddRelaxed(0);
+    Event &e = r->events[i % r->events.size()];
+    e.name = name;
+    e.category = category;
+    e.begin = begin;
+    e.end = end;
+    e.pts = pts;
+    // publish the event to toJson()
+    r->written.fetchAndStoreRelease(i + 1);
+}
+
+} //namespace QtAV
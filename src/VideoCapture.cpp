@@ -21,11 +21,11 @@
 
 
 #include <QtAV/VideoCapture.h>
+#include <QtAV/WorkerPool.h>
 #include <QtCore/QThread>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
 #include <QtCore/QRunnable>
-#include <QtCore/QThreadPool>
 #include <QtGui/QImage>
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
@@ -154,7 +154,8 @@ void VideoCapture::start()
     task->qfmt = qfmt;
     task->data = data;
     if (isAsync()) {
-        QThreadPool::globalInstance()->start(task);
+        // saving files is not urgent
+        WorkerPool::instance().start(task, -1);
     } else {
         task->run();
     }
@@ -28,6 +28,16 @@ namespace QtAV {
 
 FACTORY_DEFINE(VideoDecoder)
 
+#if QTAV_HAVE(AVFRAME_REF)
+class AVFrameBufferRef : public FrameBufferRef
+{
+public:
+    AVFrameBufferRef(AVFrame *f) : frame(av_frame_clone(f)) {}
+    ~AVFrameBufferRef() { av_frame_free(&frame); }
+    AVFrame *frame;
+};
+#endif //QTAV_HAVE(AVFRAME_REF)
+
 extern void RegisterVideoDecoderFFmpeg_Man();
 extern void RegisterVideoDecoderDXVA_Man();
 
@@ -90,12 +100,30 @@ int VideoDecoder::height() const
 VideoFrame VideoDecoder::frame()
 {
     DPTR_D(VideoDecoder);
-    if (d.width <= 0 || d.height <= 0 || !d.codec_ctx)
+    // no picture for the last packet. d.frame is the previous one
+    if (d.width <= 0 || d.height <= 0 || !d.codec_ctx || !d.got_frame_ptr)
         return VideoFrame(0, 0, VideoFormat(VideoFormat::Format_Invalid));
     //DO NOT make frame as a memeber, because VideoFrame is explictly shared!
     VideoFrame frame(d.codec_ctx->width, d.codec_ctx->height, VideoFormat((int)d.codec_ctx->pix_fmt));
     frame.setBits(d.frame->data);
     frame.setBytesPerLine(d.frame->linesize);
+#if QTAV_HAVE(AVFRAME_REF)
+    // a new reference to the same buffers. not reused by the next decode
+    if (d.codec_ctx->refcounted_frames)
+        frame.setBufferRef(new AVFrameBufferRef(d.frame));
+#endif //QTAV_HAVE(AVFRAME_REF)
+    frame.setColorSpace(d.codec_ctx->colorspace);
+    // yuvj formats are deprecated in favor of color_range, but some decoders still output them
+    switch (d.codec_ctx->pix_fmt) {
+    case QTAV_PIX_FMT_C(YUVJ420P):
+    case QTAV_PIX_FMT_C(YUVJ422P):
+    case QTAV_PIX_FMT_C(YUVJ444P):
+        frame.setColorRange(AVCOL_RANGE_JPEG);
+        break;
+    default:
+        frame.setColorRange(d.codec_ctx->color_range);
+        break;
+    }
     return frame;
 }
 
@@ -23,6 +23,7 @@
 #include "private/VideoDecoderFFmpeg_p.h"
 #include <QtAV/Packet.h>
 #include <QtAV/QtAV_Compat.h>
+#include <QtAV/Logging.h>
 #include "prepost.h"
 
 namespace QtAV {
@@ -62,17 +63,22 @@ bool VideoDecoderFFmpeg::decode(const QByteArray &encoded)
     //AVStream *stream = format_context->streams[stream_idx];
 
     //TODO: some decoders might in addition need other fields like flags&AV_PKT_FLAG_KEY
+#if QTAV_HAVE(AVFRAME_REF)
+    // the last frame is referenced by VideoFrames if still in use
+    if (d.codec_ctx->refcounted_frames)
+        av_frame_unref(d.frame);
+#endif //QTAV_HAVE(AVFRAME_REF)
     int ret = avcodec_decode_video2(d.codec_ctx, d.frame, &d.got_frame_ptr, &packet);
     //qDebug("pic_type=%c", av_get_picture_type_char(d.frame->pict_type));
     d.undecoded_size = qMin(encoded.size() - ret, encoded.size());
     //TODO: decoded format is YUV420P, YUV422P?
     av_free_packet(&packet);
     if (ret < 0) {
-        qWarning("[VideoDecoder] %s", av_err2str(ret));
+        QTAV_WARNING_LIMITED(LogDecoder, "[VideoDecoder] %s", av_err2str(ret));
         return false;
     }
     if (!d.got_frame_ptr) {
-        qWarning("no frame could be decompressed: %s", av_err2str(ret));
+        QTAV_WARNING_LIMITED(LogDecoder, "no frame could be decompressed: %s", av_err2str(ret));
         return true;
     }
     if (!d.codec_ctx->width || !d.codec_ctx->height)
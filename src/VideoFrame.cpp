@@ -42,6 +42,8 @@ public:
         , height(0)
         , format(VideoFormat::Format_Invalid)
         , textures(4, 0)
+        , color_space(AVCOL_SPC_UNSPECIFIED)
+        , color_range(AVCOL_RANGE_UNSPECIFIED)
         , conv(0)
     {}
     VideoFramePrivate(int w, int h, const VideoFormat& fmt)
@@ -50,6 +52,8 @@ public:
         , height(h)
         , format(fmt)
         , textures(4, 0)
+        , color_space(AVCOL_SPC_UNSPECIFIED)
+        , color_range(AVCOL_RANGE_UNSPECIFIED)
         , conv(0)
     {
         planes.resize(format.planeCount());
@@ -74,6 +78,8 @@ public:
         conv->setInFormat(format.pixelFormatFFmpeg());
         conv->setOutFormat(fffmt);
         conv->setInSize(width, height);
+        conv->setInColorSpace(color_space);
+        conv->setInRange(color_range);
         if (!conv->convert(planes.data(), line_sizes.data())) {
             format.setPixelFormat(VideoFormat::Format_Invalid);
             return false;
@@ -113,6 +119,7 @@ public:
     int width, height;
     VideoFormat format;
     QVector<int> textures;
+    int color_space, color_range;
 
     ImageConverter *conv;
 };
@@ -184,7 +191,21 @@ VideoFrame VideoFrame::clone() const
     for (int i = 0; i < d->format.planeCount(); ++i) {
         // TODO: is plane 0 always luma?
         int h = i == 0 ? height() : d->format.chromaHeight(height());
-        memcpy(f.bits(i), bits(i), bytesPerLine(i)*h);
+        // decoded lines are padded. the clone is packed
+        const int src_stride = bytesPerLine(i);
+        const int dst_stride = f.bytesPerLine(i);
+        if (src_stride == dst_stride) {
+            memcpy(f.bits(i), bits(i), src_stride*h);
+            continue;
+        }
+        const int line = qMin(src_stride, dst_stride);
+        const uchar *src = bits(i);
+        uchar *dst = f.bits(i);
+        for (int y = 0; y < h; ++y) {
+            memcpy(dst, src, line);
+            src += src_stride;
+            dst += dst_stride;
+        }
     }
     return f;
 }
@@ -308,6 +329,31 @@ void VideoFrame::setImageConverter(ImageConverter *conv)
     d_func()->conv = conv;
 }
 
+ImageConverter* VideoFrame::imageConverter() const
+{
+    return d_func()->conv;
+}
+
+void VideoFrame::setColorSpace(int cs)
+{
+    d_func()->color_space = cs;
+}
+
+int VideoFrame::colorSpace() const
+{
+    return d_func()->color_space;
+}
+
+void VideoFrame::setColorRange(int range)
+{
+    d_func()->color_range = range;
+}
+
+int VideoFrame::colorRange() const
+{
+    return d_func()->color_range;
+}
+
 bool VideoFrame::convertTo(const VideoFormat& fmt)
 {
     Q_D(VideoFrame);
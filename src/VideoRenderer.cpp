@@ -23,6 +23,8 @@
 #include <private/VideoRenderer_p.h>
 #include <QtAV/Filter.h>
 #include <QtAV/OSDFilter.h>
+#include <QtAV/Logging.h>
+#include <QtAV/Tracer.h>
 #include <QtCore/QCoreApplication>
 #include <QWidget>
 #include <QGraphicsItem>
@@ -50,6 +52,44 @@ bool VideoRenderer::receive(const VideoFrame &frame)
     return receiveFrame(frame);
 }
 
+VideoFormat::PixelFormat VideoRenderer::preferredPixelFormat() const
+{
+    return VideoFormat::Format_RGB32;
+}
+
+bool VideoRenderer::isSupported(VideoFormat::PixelFormat pixfmt) const
+{
+    return pixfmt == preferredPixelFormat();
+}
+
+bool VideoRenderer::isEQSupported() const
+{
+    return false;
+}
+
+void VideoRenderer::setEQ(int brightness, int contrast, int saturation)
+{
+    DPTR_D(VideoRenderer);
+    d.brightness = brightness;
+    d.contrast = contrast;
+    d.saturation = saturation;
+}
+
+int VideoRenderer::brightness() const
+{
+    return d_func().brightness;
+}
+
+int VideoRenderer::contrast() const
+{
+    return d_func().contrast;
+}
+
+int VideoRenderer::saturation() const
+{
+    return d_func().saturation;
+}
+
 void VideoRenderer::scaleInRenderer(bool q)
 {
     d_func().scale_in_renderer = q;
@@ -332,6 +372,7 @@ void VideoRenderer::resizeFrame(int width, int height)
 void VideoRenderer::handlePaintEvent()
 {
     DPTR_D(VideoRenderer);
+    Tracer::Scope trace("paint", "render");
     d.setupQuality();
     //begin paint. how about QPainter::beginNativePainting()?
     {
@@ -368,7 +409,7 @@ void VideoRenderer::handlePaintEvent()
     if (!d.filters.isEmpty() && d.filter_context && d.statistics) {
         foreach(Filter* filter, d.filters) {
             if (!filter) {
-                qWarning("a null filter!");
+                QTAV_WARNING_LIMITED(LogOutput, "a null filter!");
                 //d.filters.removeOne(filter);
                 continue;
             }
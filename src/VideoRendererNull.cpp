@@ -0,0 +1,207 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include <QtAV/VideoRendererNull.h>
+#include <QtAV/VideoRendererTypes.h>
+#include <private/VideoRenderer_p.h>
+#include <QtAV/Statistics.h>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QVector>
+#include "prepost.h"
+
+namespace QtAV {
+
+FACTORY_REGISTER_ID_AUTO(VideoRenderer, Null, "Null")
+
+void RegisterVideoRendererNull_Man()
+{
+    FACTORY_REGISTER_ID_MAN(VideoRenderer, Null, "Null")
+}
+
+class VideoRendererNullPrivate : public VideoRendererPrivate
+{
+public:
+    VideoRendererNullPrivate()
+        : VideoRendererPrivate()
+        , pixel_format(VideoFormat::Format_Invalid)
+        , callback(0)
+        , opaque(0)
+        , head(0)
+        , tail(0)
+        , received(0)
+        , queue_dropped(0)
+        , pipeline_dropped0(0)
+        , pipeline_late0(0)
+    {
+        default_event_filter = false;
+    }
+    Statistics::Pipeline::Snapshot pipeline() const {
+        if (!statistics)
+            return Statistics::Pipeline::Snapshot();
+        return statistics->video_pipeline.snapshot();
+    }
+
+    VideoFormat::PixelFormat pixel_format;
+    VideoRendererNull::FrameCallback callback;
+    void *opaque;
+    // single producer(receiveFrame()), single consumer(takeFrame()) ring. 1 slot is always empty
+    QVector<VideoFrame> queue;
+    QAtomicInt head, tail;
+    mutable QAtomicInt received, queue_dropped;
+    qint64 pipeline_dropped0, pipeline_late0;
+};
+
+VideoRendererNull::VideoRendererNull()
+    : VideoRenderer(*new VideoRendererNullPrivate())
+{
+}
+
+VideoRendererNull::~VideoRendererNull()
+{
+}
+
+VideoRendererId VideoRendererNull::id() const
+{
+    return VideoRendererId_Null;
+}
+
+void VideoRendererNull::setPixelFormat(VideoFormat::PixelFormat fmt)
+{
+    d_func().pixel_format = fmt;
+}
+
+VideoFormat::PixelFormat VideoRendererNull::pixelFormat() const
+{
+    return d_func().pixel_format;
+}
+
+VideoFormat::PixelFormat VideoRendererNull::preferredPixelFormat() const
+{
+    DPTR_D(const VideoRendererNull);
+    if (d.pixel_format == VideoFormat::Format_Invalid)
+        return VideoRenderer::preferredPixelFormat();
+    return d.pixel_format;
+}
+
+bool VideoRendererNull::isSupported(VideoFormat::PixelFormat pixfmt) const
+{
+    DPTR_D(const VideoRendererNull);
+    return d.pixel_format == VideoFormat::Format_Invalid || d.pixel_format == pixfmt;
+}
+
+void VideoRendererNull::setFrameCallback(FrameCallback callback, void *opaque)
+{
+    DPTR_D(VideoRendererNull);
+    d.callback = callback;
+    d.opaque = opaque;
+}
+
+void VideoRendererNull::setQueueSize(int frames)
+{
+    DPTR_D(VideoRendererNull);
+    d.queue.clear();
+    if (frames > 0)
+        d.queue.resize(frames + 1);
+    d.head.fetchAndStoreOrdered(0);
+    d.tail.fetchAndStoreOrdered(0);
+}
+
+int VideoRendererNull::queueSize() const
+{
+    return qMax(d_func().queue.size() - 1, 0);
+}
+
+bool VideoRendererNull::takeFrame(VideoFrame *frame)
+{
+    DPTR_D(VideoRendererNull);
+    if (d.queue.isEmpty())
+        return false;
+    const int h = d.head.fetchAndAddRelaxed(0);
+    if (h == d.tail.fetchAndAddAcquire(0))
+        return false;
+    *frame = d.queue[h];
+    d.queue[h] = VideoFrame(); // release the data
+    d.head.fetchAndStoreRelease((h + 1) % d.queue.size());
+    return true;
+}
+
+qint64 VideoRendererNull::receivedFrames() const
+{
+    return d_func().received.fetchAndAddRelaxed(0);
+}
+
+qint64 VideoRendererNull::droppedFrames() const
+{
+    DPTR_D(const VideoRendererNull);
+    return d.queue_dropped.fetchAndAddRelaxed(0) + d.pipeline().dropped - d.pipeline_dropped0;
+}
+
+qint64 VideoRendererNull::lateFrames() const
+{
+    DPTR_D(const VideoRendererNull);
+    return d.pipeline().late - d.pipeline_late0;
+}
+
+void VideoRendererNull::resetCounters()
+{
+    DPTR_D(VideoRendererNull);
+    d.received.fetchAndStoreRelaxed(0);
+    d.queue_dropped.fetchAndStoreRelaxed(0);
+    const Statistics::Pipeline::Snapshot s = d.pipeline();
+    d.pipeline_dropped0 = s.dropped;
+    d.pipeline_late0 = s.late;
+}
+
+bool VideoRendererNull::receiveFrame(const VideoFrame &frame)
+{
+    DPTR_D(VideoRendererNull);
+    d.received.fetchAndAddRelaxed(1);
+    if (d.callback)
+        d.callback(frame, d.opaque);
+    if (d.queue.isEmpty())
+        return true;
+    const int t = d.tail.fetchAndAddRelaxed(0);
+    const int next = (t + 1) % d.queue.size();
+    if (next == d.head.fetchAndAddAcquire(0)) {
+        d.queue_dropped.fetchAndAddRelaxed(1);
+        return true;
+    }
+    // frames from the player own their buffer. a frame sent directly may not
+    d.queue[t] = frame.isBufferOwned() ? frame : frame.clone();
+    d.tail.fetchAndStoreRelease(next);
+    return true;
+}
+
+bool VideoRendererNull::needUpdateBackground() const
+{
+    return false;
+}
+
+bool VideoRendererNull::needDrawFrame() const
+{
+    return false;
+}
+
+void VideoRendererNull::drawFrame()
+{
+}
+
+} //namespace QtAV
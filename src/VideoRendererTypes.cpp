@@ -50,6 +50,7 @@ VideoRendererId VideoRendererId_GLWidget = 4;
 VideoRendererId VideoRendererId_GDI = 5;
 VideoRendererId VideoRendererId_Direct2D = 6;
 VideoRendererId VideoRendererId_XV = 7;
+VideoRendererId VideoRendererId_Null = 8;
 
 //QPainterRenderer is abstract. So can not register(operator new will needed)
 FACTORY_REGISTER_ID_AUTO(VideoRenderer, Widget, "QWidegt")
@@ -134,9 +135,12 @@ VideoRendererId XVRenderer::id() const
 }
 #endif //QTAV_HAVE(XV)
 
+extern void RegisterVideoRendererNull_Man();
+
 void VideoRenderer_RegisterAll()
 {
     RegisterVideoRendererWidget_Man();
+    RegisterVideoRendererNull_Man();
 #if QTAV_HAVE(GL)
     RegisterVideoRendererGLWidget_Man();
 #endif //QTAV_HAVE(GL)
@@ -27,11 +27,13 @@
 #include <QtAV/VideoDecoder.h>
 #include <QtAV/VideoRenderer.h>
 #include <QtAV/ImageConverter.h>
+#include <QtAV/Logging.h>
 #include <QtCore/QFileInfo>
 #include <QtAV/Statistics.h>
 #include <QtAV/Filter.h>
 #include <QtAV/FilterContext.h>
 #include <QtAV/OutputSet.h>
+#include <QtAV/Tracer.h>
 #include <QtAV/ImageConverterTypes.h>
 #include <QtAV/QtAV_Compat.h>
 
@@ -153,11 +155,14 @@ void VideoThread::run()
         dec->resizeVideoFrame(0, 0);
     }
     Packet pkt;
+    // shares the counters of player's statistics
+    Statistics::Pipeline pipeline = d.statistics ? d.statistics->video_pipeline : Statistics::Pipeline();
     /*!
      * if we skip some frames(e.g. seek, drop frames to speed up), then then first frame to decode must
      * be a key frame for hardware decoding. otherwise may crash
      */
     bool wait_key_frame = false;
+    bool drained = false;
     while (!d.stop) {
         processNextTask();
         //TODO: why put it at the end of loop then playNextFrame() not work?
@@ -172,23 +177,27 @@ void VideoThread::run()
             d.stop = d.demux_end;
         }
         if (d.stop) {
-            qDebug("video thread stop before take packet");
+            QTAV_DEBUG(LogVideo, "video thread stop before take packet");
             break;
         }
         if(!pkt.isValid()) {
             pkt = d.packets.take(); //wait to dequeue
+            pipeline.setQueueDepth(d.packets.size());
+            if (pkt.read_time > 0)
+                pipeline.addLatency(Statistics::Pipeline::Queue, Statistics::timestamp() - pkt.read_time);
         }
         //Compare to the clock
         if (!pkt.isValid()) {
             // may be we should check other information. invalid packet can come from
             wait_key_frame = true;
-            qDebug("Invalid packet! flush video codec context!!!!!!!!!! video packet queue size: %d", d.packets.size());
+            QTAV_DEBUG_LIMITED(LogVideo, "Invalid packet! flush video codec context!!!!!!!!!! video packet queue size: %d", d.packets.size());
             dec->flush();
             continue;
         }
         qreal pts = pkt.pts;
         // TODO: delta ref time
-        d.delay = pts - d.clock->value();
+        // free run: no wait and no drop. the clock follows the decoded frames
+        d.delay = d.free_run ? 0 : pts - d.clock->value();
         /*
          *after seeking forward, a packet may be the old, v packet may be
          *the new packet, then the d.delay is very large, omit it.
@@ -216,36 +225,42 @@ void VideoThread::run()
         }
         //audio packet not cleaned up?
         if (d.delay < 3) {
-            while (d.delay > kSyncThreshold) { //Slow down
-                //d.delay_cond.wait(&d.mutex, d.delay*1000); //replay may fail. why?
-                //qDebug("~~~~~wating for %f msecs", d.delay*1000);
-                usleep(kSyncThreshold * 1000000UL);
-                if (d.stop)
-                    d.delay = 0;
-                else
-                    d.delay -= kSyncThreshold;
-            }
-            if (d.delay > 0)
-                usleep(d.delay * 1000000UL);
+            // absolute deadline. stop, pause and seek wake up the wait and the packet is scheduled again
+            if (d.delay > 0 && !waitFor(d.delay))
+                continue;
             d.clock->updateVideoPts(pts); //here?
             if (d.stop) {
-                qDebug("video thread stop before decode()");
+                QTAV_DEBUG(LogVideo, "video thread stop before decode()");
                 break;
             }
         } else {
-            if (d.delay > 0)
-                msleep(40);
+            if (d.delay > 0 && !waitFor(0.04))
+                continue;
         }
         if (wait_key_frame) {
             if (pkt.hasKeyFrame)
                 wait_key_frame = false;
             else {
                 pkt = Packet();
+                pipeline.addSkipped();
                 //qDebug("waiting for key frame. queue size: %d. pkt.size: %d", d.packets.size(), pkt.data.size());
                 continue;
             }
         }
-        if (!dec->decode(pkt.data)) {
+        const qint64 read_time = pkt.read_time;
+        const bool drain = pkt.drain;
+        if (drained) {
+            // a drained decoder accepts no more input
+            dec->flush();
+            drained = false;
+        }
+        const qint64 decode_start = Statistics::timestamp();
+        bool decoded = false;
+        {
+            Tracer::Scope trace("decode", "video", pkt.pts);
+            decoded = dec->decode(pkt.data);
+        }
+        if (!decoded) {
             pkt = Packet();
             continue;
         } else {
@@ -256,15 +271,26 @@ void VideoThread::run()
                 pkt = Packet();
             }
         }
+        pipeline.addLatency(Statistics::Pipeline::Decode, Statistics::timestamp() - decode_start);
 
-        if (skip_render)
+        if (skip_render) {
+            pipeline.addDropped();
             continue;
+        }
         VideoFrame frame = dec->frame();
+        if (drain && pkt.data.isEmpty()) {
+            // the decoder may hold the picture back for reordering. get it now
+            if (!frame.isValid() && dec->decode(QByteArray()))
+                frame = dec->frame();
+            drained = true;
+        }
         if (!frame.isValid())
             continue;
         d.conv->setInFormat(frame.pixelFormatFFmpeg());
         d.conv->setInSize(frame.width(), frame.height());
         d.conv->setOutSize(frame.width(), frame.height());
+        d.conv->setInColorSpace(frame.colorSpace());
+        d.conv->setInRange(frame.colorRange());
         frame.setImageConverter(d.conv);
         Q_ASSERT(d.statistics);
         d.statistics->video.current_time = QTime(0, 0, 0).addMSecs(int(pts * 1000.0)); //TODO: is it expensive?
@@ -274,6 +300,7 @@ void VideoThread::run()
             QMutexLocker locker(&d.mutex);
             Q_UNUSED(locker);
             if (!d.filters.isEmpty()) {
+                const qint64 filter_start = Statistics::timestamp();
                 //sort filters by format. vo->defaultFormat() is the last
                 foreach (Filter *filter, d.filters) {
                     if (d.stop) {
@@ -283,6 +310,7 @@ void VideoThread::run()
                         continue;
                     filter->process(d.filter_context, d.statistics, &frame);
                 }
+                pipeline.addLatency(Statistics::Pipeline::Filter, Statistics::timestamp() - filter_start);
             }
         }
 
@@ -297,20 +325,28 @@ void VideoThread::run()
         }
 
         if (d.stop) {
-            qDebug("video thread stop before send decoded data");
+            QTAV_DEBUG(LogVideo, "video thread stop before send decoded data");
             break;
         }
-        if (!frame.convertTo(VideoFormat::Format_RGB32)) {
-            /*
-             * TODO: send andway and let renderer deal with it?
-             * renderer may update background but no frame to graw, so flickers
-             * may crash for some renderer(e.g. d2d) without validate and render an invalid frame
-             */
-            continue;
-        }
-        d.outputSet->sendVideoFrame(frame); //TODO: group by format, convert group by group
+        d.statistics->video_only.lateness = d.free_run ? 0 : d.clock->value() - pts;
+        if (d.statistics->video_only.lateness > kSyncThreshold)
+            pipeline.addLate();
+        // converted by OutputSet once for each format the renderers require. it records Convert and Render
+        d.outputSet->sendVideoFrame(frame);
+        if (read_time > 0)
+            pipeline.addLatency(Statistics::Pipeline::Total, Statistics::timestamp() - read_time);
         d.capture->setPosition(pts);
         if (d.capture->isRequested()) {
+            // renderers may hold the frame. convert to rgb32 without touching it
+            d.conv->setOutFormat(PIX_FMT);
+            QVector<const quint8*> planes(4, 0);
+            QVector<int> strides(4, 0);
+            for (int i = 0; i < qMin(frame.planeCount(), 4); ++i) {
+                planes[i] = frame.bits(i);
+                strides[i] = frame.bytesPerLine(i);
+            }
+            if (!d.conv->convert(planes.constData(), strides.constData()))
+                continue;
             bool auto_name = d.capture->name.isEmpty() && d.capture->autoSave();
             if (auto_name) {
                 QString cap_name;
@@ -318,9 +354,8 @@ void VideoThread::run()
                     cap_name = QFileInfo(d.statistics->url).completeBaseName();
                 d.capture->setCaptureName(cap_name + "_" + QString::number(pts, 'f', 3));
             }
-            //TODO: what if not rgb32 now? detach the frame
             //FIXME: why frame.data() may crash?
-            d.capture->setRawImage(frame.frameData(), frame.width(), frame.height(), frame.imageFormat());
+            d.capture->setRawImage(d.conv->outData(), frame.width(), frame.height(), QImage::Format_RGB32);
             d.capture->start();
             if (auto_name)
                 d.capture->setCaptureName("");
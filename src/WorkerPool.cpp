@@ -0,0 +1,176 @@
+/******************************************************************************
+    QtAV:  Media play library based on Qt and FFmpeg
+    Copyright (C) 2012-2013 Wang Bin <wbsecg1@gmail.com>
+
+*   This file is part of QtAV
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+******************************************************************************/
+
+#include "QtAV/WorkerPool.h"
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+namespace QtAV {
+
+class WorkerPoolPrivate : public DPtrPrivate<WorkerPool>
+{
+public:
+    WorkerPoolPrivate()
+        : budget(qMax(1, QThread::idealThreadCount()))
+        , used(0)
+        , decoders(0)
+        , reserved(0)
+    {
+        pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+        background.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    }
+    ~WorkerPoolPrivate() {
+        background.waitForDone();
+        pool.waitForDone();
+    }
+
+    QThreadPool pool;
+    QThreadPool background; //long tasks
+    mutable QMutex mutex; //codec thread budget
+    int budget;
+    int used;
+    int decoders;
+    int reserved; //decoders expected
+};
+
+WorkerPool& WorkerPool::instance()
+{
+    static WorkerPool sPool;
+    return sPool;
+}
+
+WorkerPool::WorkerPool()
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+}
+
+QThreadPool* WorkerPool::threadPool()
+{
+    return &d_func().pool;
+}
+
+void WorkerPool::start(QRunnable *task, int priority)
+{
+    d_func().pool.start(task, priority);
+}
+
+void WorkerPool::setMaxThreads(int threads)
+{
+    d_func().pool.setMaxThreadCount(qMax(1, threads));
+}
+
+int WorkerPool::maxThreads() const
+{
+    return d_func().pool.maxThreadCount();
+}
+
+void WorkerPool::startBackground(QRunnable *task, int priority)
+{
+    d_func().background.start(task, priority);
+}
+
+void WorkerPool::setMaxBackgroundThreads(int threads)
+{
+    d_func().background.setMaxThreadCount(qMax(1, threads));
+}
+
+int WorkerPool::maxBackgroundThreads() const
+{
+    return d_func().background.maxThreadCount();
+}
+
+void WorkerPool::setCodecThreadBudget(int threads)
+{
+    DPTR_D(WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.budget = qMax(0, threads);
+}
+
+int WorkerPool::codecThreadBudget() const
+{
+    DPTR_D(const WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.budget;
+}
+
+int WorkerPool::codecThreadsInUse() const
+{
+    DPTR_D(const WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    return d.used;
+}
+
+void WorkerPool::reserveDecoders(int n)
+{
+    DPTR_D(WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.reserved += qMax(0, n);
+}
+
+void WorkerPool::releaseDecoders(int n)
+{
+    DPTR_D(WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    d.reserved = qMax(0, d.reserved - qMax(0, n));
+}
+
+int WorkerPool::acquireCodecThreads(int wanted)
+{
+    DPTR_D(WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    wanted = qMax(1, wanted);
+    int granted = wanted;
+    if (d.budget > 0) {
+        // an equal share of the decoders expected. without reservation, leave room for 1 more decoder,
+        // so the 1st decoder does not take all threads
+        const int expected = d.reserved > d.decoders ? d.reserved : d.decoders + 2;
+        const int share = qMax(1, d.budget/expected);
+        const int left = qMax(1, d.budget - d.used);
+        granted = qMin(wanted, qMin(share, left));
+    }
+    ++d.decoders;
+    d.used += granted;
+    return granted;
+}
+
+void WorkerPool::releaseCodecThreads(int threads)
+{
+    DPTR_D(WorkerPool);
+    QMutexLocker lock(&d.mutex);
+    Q_UNUSED(lock);
+    if (d.decoders <= 0)
+        return;
+    --d.decoders;
+    d.used = qMax(0, d.used - threads);
+}
+
+} //namespace QtAV
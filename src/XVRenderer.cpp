@@ -24,6 +24,7 @@
 */
 #include "QtAV/XVRenderer.h"
 #include <QResizeEvent>
+#include <string.h>
 #include "private/XVRenderer_p.h"
 namespace QtAV {
 
@@ -53,14 +54,33 @@ bool XVRenderer::receiveFrame(const VideoFrame& frame)
     //TODO: if date is deep copied, mutex can be avoided
     QMutexLocker locker(&d.img_mutex);
     Q_UNUSED(locker);
+    if (frame.pixelFormat() != VideoFormat::Format_YUV420P)
+        return false;
     d.video_frame = frame;
-    d.video_frame.convertTo(VideoFormat::Format_YUV420P);
-    d.xv_image->data = (char*)d.video_frame.bits();
+    // XvImage has its own offsets and pitches. YV12 planes are in Y, V, U order
+    static const int kSrcPlane[] = { 0, 2, 1 };
+    for (int i = 0; i < qMin(3, d.xv_image->num_planes); ++i) {
+        const int plane = kSrcPlane[i];
+        const int lines = qMin(frame.planeHeight(plane), i == 0 ? d.xv_image->height : (d.xv_image->height + 1)/2);
+        const int bytes = qMin(frame.planeWidth(plane), d.xv_image->pitches[i]);
+        const uchar *src = frame.bits(plane);
+        char *dst = d.xv_image->data + d.xv_image->offsets[i];
+        for (int y = 0; y < lines; ++y) {
+            memcpy(dst, src, bytes);
+            src += frame.bytesPerLine(plane);
+            dst += d.xv_image->pitches[i];
+        }
+    }
 
     update();
     return true;
 }
 
+VideoFormat::PixelFormat XVRenderer::preferredPixelFormat() const
+{
+    return VideoFormat::Format_YUV420P;
+}
+
 QPaintEngine* XVRenderer::paintEngine() const
 {
     return 0; //use native engine
@@ -112,7 +112,7 @@ config_gl {
     SOURCES += GLWidgetRenderer.cpp
     HEADERS += QtAV/private/GLWidgetRenderer_p.h
     SDK_HEADERS += QtAV/GLWidgetRenderer.h
-    OTHER_FILES += shaders/yuv_rgb.f.glsl
+    OTHER_FILES += shaders/yuv_rgb.f.glsl shaders/rgb.f.glsl
 }
 config_cuda {
     DEFINES += QTAV_HAVE_CUDA=1
@@ -146,12 +146,16 @@ SOURCES += \
     AudioThread.cpp \
     AVThread.cpp \
     AudioDecoder.cpp \
+    AudioDSP.cpp \
+    AudioFilter.cpp \
     AudioFormat.cpp \
     AudioFrame.cpp \
     AudioOutput.cpp \
+    AudioOutputNull.cpp \
     AudioOutputTypes.cpp \
     AudioResampler.cpp \
     AudioResamplerTypes.cpp \
+    AudioTimeStretcher.cpp \
     AVDecoder.cpp \
     AVDemuxer.cpp \
     AVDemuxThread.cpp \
@@ -159,6 +163,8 @@ SOURCES += \
     Filter.cpp \
     FilterContext.cpp \
     FilterManager.cpp \
+    FrameExtractor.cpp \
+    GOPCache.cpp \
     GraphicsItemRenderer.cpp \
     ImageConverter.cpp \
     ImageConverterFF.cpp \
@@ -167,25 +173,31 @@ SOURCES += \
     OSD.cpp \
     OSDFilter.cpp \
     Packet.cpp \
+    PlayerGroup.cpp \
     AVError.cpp \
     AVPlayer.cpp \
     VideoCapture.cpp \
     VideoFormat.cpp \
     VideoFrame.cpp \
     VideoRenderer.cpp \
+    VideoRendererNull.cpp \
     VideoRendererTypes.cpp \
     VideoOutputEventFilter.cpp \
     WidgetRenderer.cpp \
+    WorkerPool.cpp \
     AVOutput.cpp \
     OutputSet.cpp \
     AVClock.cpp \
+    Logging.cpp \
     Statistics.cpp \
+    Tracer.cpp \
     VideoDecoder.cpp \
     VideoDecoderTypes.cpp \
     VideoDecoderFFmpeg.cpp \
     VideoDecoderFFmpegHW.cpp \
     VideoThread.cpp \
     QAVIOContext.cpp \
+    ReverseThread.cpp \
     CommonTypes.cpp
 
 SDK_HEADERS *= \
@@ -194,10 +206,13 @@ SDK_HEADERS *= \
     QtAV/QtAV_Global.h \
     QtAV/AudioResampler.h \
     QtAV/AudioResamplerTypes.h \
+    QtAV/AudioTimeStretcher.h \
     QtAV/AudioDecoder.h \
+    QtAV/AudioFilter.h \
     QtAV/AudioFormat.h \
     QtAV/AudioFrame.h \
     QtAV/AudioOutput.h \
+    QtAV/AudioOutputNull.h \
     QtAV/AudioOutputTypes.h \
     QtAV/AVDecoder.h \
     QtAV/AVDemuxer.h \
@@ -205,6 +220,7 @@ SDK_HEADERS *= \
     QtAV/Filter.h \
     QtAV/FilterContext.h \
     QtAV/Frame.h \
+    QtAV/FrameExtractor.h \
     QtAV/GraphicsItemRenderer.h \
     QtAV/ImageConverter.h \
     QtAV/ImageConverterTypes.h \
@@ -212,12 +228,15 @@ SDK_HEADERS *= \
     QtAV/OSD.h \
     QtAV/OSDFilter.h \
     QtAV/Packet.h \
+    QtAV/PlayerGroup.h \
     QtAV/AVError.h \
     QtAV/AVPlayer.h \
     QtAV/VideoCapture.h \
     QtAV/VideoRenderer.h \
+    QtAV/VideoRendererNull.h \
     QtAV/VideoRendererTypes.h \
     QtAV/WidgetRenderer.h \
+    QtAV/WorkerPool.h \
     QtAV/AVOutput.h \
     QtAV/AVClock.h \
     QtAV/VideoDecoder.h \
@@ -227,7 +246,9 @@ SDK_HEADERS *= \
     QtAV/VideoFormat.h \
     QtAV/VideoFrame.h \
     QtAV/FactoryDefine.h \
+    QtAV/Logging.h \
     QtAV/Statistics.h \
+    QtAV/Tracer.h \
     QtAV/version.h
 
 
@@ -240,10 +261,13 @@ HEADERS *= \
     QtAV/VideoThread.h \
     QtAV/VideoOutputEventFilter.h \
     QtAV/OutputSet.h \
+    QtAV/GOPCache.h \
+    QtAV/ReverseThread.h \
     QtAV/QtAV_Compat.h \
     QtAV/singleton.h \
     QtAV/factory.h \
     QtAV/FilterManager.h \
+    QtAV/private/AudioDSP_p.h \
     QtAV/private/AudioOutput_p.h \
     QtAV/private/AudioResampler_p.h \
     QtAV/private/AVThread_p.h \
@@ -0,0 +1,19 @@
+#ifdef GL_ES
+// Set default precision to medium
+precision mediump int;
+precision mediump float;
+#else
+#define highp
+#define mediump
+#define lowp
+#endif
+
+uniform sampler2D u_Texture0;
+varying lowp vec2 v_TexCoords;
+
+// brightness, contrast, saturation. identity if not changed. computed by the renderer
+uniform mat4 u_colorMatrix;
+void main()
+{
+    gl_FragColor = clamp(u_colorMatrix*vec4(texture2D(u_Texture0, v_TexCoords).rgb, 1), 0.0, 1.0);
+}
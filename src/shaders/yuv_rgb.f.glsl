@@ -14,24 +14,19 @@ uniform sampler2D u_Texture1;
 uniform sampler2D u_Texture2;
 varying lowp vec2 v_TexCoords;
 
+// SAMPLE_Y, SAMPLE_U, SAMPLE_V are generated by the renderer from the pixel format, e.g. nv12, yuyv, 10bit
+#ifndef SAMPLE_Y
+#define SAMPLE_Y texture2D(u_Texture0, v_TexCoords).r
+#define SAMPLE_U texture2D(u_Texture1, v_TexCoords).r
+#define SAMPLE_V texture2D(u_Texture2, v_TexCoords).r
+#endif //SAMPLE_Y
+
 //http://en.wikipedia.org/wiki/YUV calculation used
 //http://www.fourcc.org/fccyvrgb.php
 //GLSL: col first
-// use bt601
-const mat4 colorMatrix = mat4(1, 1, 1, 0,
-                              0, -0.344, 1.773, 0,
-                              1.403, -0.714, 0, 0,
-                              0, 0, 0, 1)
-                        * mat4(1, 0, 0, 0,
-                               0, 1, 0, 0,
-                               0, 0, 1, 0,
-                               0, -0.5, -0.5, 1);
+// yuv => rgb with range, colorspace and brightness, contrast, saturation. computed by the renderer
+uniform mat4 u_colorMatrix;
 void main()
 {
-    // use r, g, a to work for both yv12 and nv12
-    gl_FragColor = clamp(colorMatrix* vec4(texture2D(u_Texture0, v_TexCoords).r,
-                                           texture2D(u_Texture1, v_TexCoords).g,
-                                           texture2D(u_Texture2, v_TexCoords).a,
-                                           1)
-                      , 0.0, 1.0);
+    gl_FragColor = clamp(u_colorMatrix*vec4(SAMPLE_Y, SAMPLE_U, SAMPLE_V, 1), 0.0, 1.0);
 }
@@ -0,0 +1,11 @@
+TEMPLATE = app
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+STATICLINK = 0
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+
+SOURCES += main.cpp
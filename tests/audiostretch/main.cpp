@@ -0,0 +1,77 @@
+/*
+ * Time-stretch cost benchmark. No media file is required.
+ * usage: audiostretch [seconds]
+ * Prints the realtime factor (seconds of input processed per second of cpu) for each speed,
+ * with the vectorized kernels and with the C kernels.
+ */
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtCore/qmath.h>
+#include <QtAV/AudioFormat.h>
+#include <QtAV/AudioFrame.h>
+#include <QtAV/AudioTimeStretcher.h>
+#include <QtAV/private/AudioDSP_p.h>
+#include <stdio.h>
+
+using namespace QtAV;
+
+static QByteArray generate(const AudioFormat& fmt, int frames)
+{
+    QByteArray data;
+    data.resize(frames*fmt.bytesPerFrame());
+    float *d = (float*)data.data();
+    quint32 seed = 1;
+    for (int i = 0; i < frames; ++i) {
+        // 2 tones and some noise, so the similarity search does not converge to a trivial offset
+        seed = seed*1664525u + 1013904223u;
+        const float noise = float(seed >> 8)/float(1 << 24) - 0.5f;
+        const float t = float(i)/float(fmt.sampleRate());
+        const float v = 0.4f*qSin(2.0*M_PI*440.0*t) + 0.2f*qSin(2.0*M_PI*1234.5*t) + 0.05f*noise;
+        for (int c = 0; c < fmt.channels(); ++c)
+            d[i*fmt.channels() + c] = v;
+    }
+    return data;
+}
+
+static void run(const QByteArray& data, const AudioFormat& fmt, qreal speed)
+{
+    const int chunk = 1024; // about the size of a decoded frame
+    const int frames = data.size()/fmt.bytesPerFrame();
+    AudioTimeStretcher ts;
+    ts.setSpeed(speed);
+    qint64 out_frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int pos = 0; pos < frames; pos += chunk) {
+        const int n = qMin(chunk, frames - pos);
+        AudioFrame in(data.mid(pos*fmt.bytesPerFrame(), n*fmt.bytesPerFrame()), fmt);
+        out_frames += ts.process(in).samplesPerChannel();
+    }
+    const qint64 ns = timer.nsecsElapsed();
+    const qreal duration = qreal(frames)/qreal(fmt.sampleRate());
+    printf("%-5s speed %.2f: %8.2f ms, %7.1f ns/output frame, realtime x%.0f, output %.3fs\n"
+           , AudioDSP::simdName(), speed, qreal(ns)/1e6, qreal(ns)/qreal(qMax<qint64>(out_frames, 1))
+           , duration/(qreal(ns)/1e9), qreal(out_frames)/qreal(fmt.sampleRate()));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    qreal seconds = 60;
+    if (a.arguments().size() > 1)
+        seconds = qMax(a.arguments().at(1).toDouble(), 1.0);
+    AudioFormat fmt;
+    fmt.setSampleFormat(AudioFormat::SampleFormat_Float);
+    fmt.setSampleRate(44100);
+    fmt.setChannels(2);
+    const QByteArray data = generate(fmt, int(seconds*fmt.sampleRate()));
+    printf("%.0fs stereo float %dHz\n", seconds, fmt.sampleRate());
+    const qreal speeds[] = { 0.75, 1.25, 1.5, 2.0, 3.0 };
+    for (int simd = 1; simd >= 0; --simd) {
+        AudioDSP::setSIMDEnabled(simd);
+        for (size_t i = 0; i < sizeof(speeds)/sizeof(speeds[0]); ++i)
+            run(data, fmt, speeds[i]);
+    }
+    return 0;
+}
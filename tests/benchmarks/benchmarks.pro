@@ -0,0 +1,12 @@
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+STATICLINK = 0
+PROJECTROOT = $$PWD/../..
+include($$PROJECTROOT/src/libQtAV.pri)
+preparePaths($$OUT_PWD/../../out)
+# synthetic media is encoded with FFmpeg
+LIBS += -lavformat -lavcodec -lavutil
+
+SOURCES += main.cpp
@@ -0,0 +1,828 @@
+/*
+ * Headless benchmarks of the playback pipeline. Synthetic media is generated, no file or device is required.
+ * usage: benchmarks [-o result.json] [-filter name] [-repeat n] [-seconds s] [-size WxH] [-speed x] [-keep]
+ *   -o       also write the results as json, e.g. to compare with a previous run
+ *   -filter  run the benchmarks whose name contains the text
+ *   -repeat  runs of each micro benchmark. the median is reported. default 3
+ *   -seconds duration of the generated media. default 10
+ *   -size    video size of the generated media. default 1280x720
+ *   -speed   playback speed of the player benchmark. default 1
+ *   -keep    do not remove the generated media
+ * For each benchmark: items/s, ns/item and heap allocations/item. Allocations are counted on glibc
+ * (malloc family, including FFmpeg) or by operator new elsewhere.
+ */
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QEventLoop>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/qmath.h>
+#include <QtAV/AVDemuxer.h>
+#include <QtAV/AVPlayer.h>
+#include <QtAV/AudioFormat.h>
+#include <QtAV/AudioFrame.h>
+#include <QtAV/AudioOutputNull.h>
+#include <QtAV/AudioResampler.h>
+#include <QtAV/AudioResamplerTypes.h>
+#include <QtAV/FrameExtractor.h>
+#include <QtAV/ImageConverter.h>
+#include <QtAV/ImageConverterTypes.h>
+#include <QtAV/Packet.h>
+#include <QtAV/Statistics.h>
+#include <QtAV/VideoDecoder.h>
+#include <QtAV/VideoDecoderTypes.h>
+#include <QtAV/VideoFrame.h>
+#include <QtAV/VideoRendererNull.h>
+#include <QtAV/QtAV_Compat.h>
+#include <QtAV/private/AudioDSP_p.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <new>
+
+using namespace QtAV;
+
+static QBasicAtomicInt gAllocs = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void *ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+void* calloc(size_t n, size_t size)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    return __libc_calloc(n, size);
+}
+void* realloc(void *ptr, size_t size)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    return __libc_realloc(ptr, size);
+}
+void* memalign(size_t alignment, size_t size)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+} //extern "C"
+#else
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    gAllocs.fetchAndAddRelaxed(1);
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+void operator delete[](void *p) throw()
+{
+    free(p);
+}
+#endif //defined(__GLIBC__)
+
+static int allocations()
+{
+    return gAllocs.fetchAndAddRelaxed(0);
+}
+
+struct Options {
+    Options() : repeat(3), seconds(10), width(1280), height(720), fps(25), speed(1.0), keep(false) {}
+    QString output, filter, media;
+    int repeat;
+    qreal seconds;
+    int width, height, fps;
+    qreal speed;
+    bool keep;
+};
+
+struct Result {
+    Result() : items(0), ns(0), allocs(0) {}
+    QString name, unit;
+    qint64 items;
+    qint64 ns;
+    qint64 allocs;
+    QList<QPair<QString, qreal> > extra;
+    qreal nsPerItem() const { return items > 0 ? qreal(ns)/qreal(items) : 0; }
+    bool operator<(const Result& other) const { return nsPerItem() < other.nsPerItem(); }
+};
+
+// measures the code between start() and stop(). setup is excluded
+class Measure {
+public:
+    Measure() : allocs0(0), ns(0), allocs(0) {}
+    void start() {
+        allocs0 = allocations();
+        timer.start();
+    }
+    void stop() {
+        ns = timer.nsecsElapsed();
+        allocs = allocations() - allocs0;
+    }
+    Result result(const QString& name, const QString& unit, qint64 items) const {
+        Result r;
+        r.name = name;
+        r.unit = unit;
+        r.items = items;
+        r.ns = ns;
+        r.allocs = allocs;
+        return r;
+    }
+private:
+    QElapsedTimer timer;
+    int allocs0;
+    qint64 ns;
+    qint64 allocs;
+};
+
+static Options gOpt;
+static QList<Result> gResults;
+
+static bool selected(const QString& name)
+{
+    return gOpt.filter.isEmpty() || name.contains(gOpt.filter);
+}
+
+static void report(const Result& r)
+{
+    printf("%-44s %12.1f %s/s %12.1f ns/%s %8.2f allocs/%s", qPrintable(r.name)
+           , r.ns > 0 ? qreal(r.items)*1e9/qreal(r.ns) : 0, qPrintable(r.unit)
+           , r.nsPerItem(), qPrintable(r.unit)
+           , r.items > 0 ? qreal(r.allocs)/qreal(r.items) : 0, qPrintable(r.unit));
+    for (int i = 0; i < r.extra.size(); ++i)
+        printf(" %s=%.1f", qPrintable(r.extra.at(i).first), r.extra.at(i).second);
+    printf("\n");
+    fflush(stdout);
+    gResults.append(r);
+}
+
+// runs a micro benchmark gOpt.repeat times and reports the median
+template<typename Bench>
+static void run(const QString& name, Bench bench)
+{
+    if (!selected(name))
+        return;
+    QList<Result> results;
+    for (int i = 0; i < gOpt.repeat; ++i) {
+        Result r = bench();
+        if (r.items <= 0) {
+            printf("%-44s failed\n", qPrintable(name));
+            return;
+        }
+        results.append(r);
+    }
+    qSort(results);
+    Result r = results.at(results.size()/2);
+    r.name = name;
+    report(r);
+}
+
+/************************ synthetic media ************************/
+static void fillPicture(AVFrame *f, int w, int h, int i)
+{
+    // moving gradients and a block, so that motion estimation and entropy coding have some work
+    for (int y = 0; y < h; ++y) {
+        uchar *l = f->data[0] + y*f->linesize[0];
+        for (int x = 0; x < w; ++x)
+            l[x] = uchar((x + y + i*3) ^ ((x/16 + i) & 0x10 ? 0x40 : 0));
+    }
+    for (int y = 0; y < h/2; ++y) {
+        uchar *u = f->data[1] + y*f->linesize[1];
+        uchar *v = f->data[2] + y*f->linesize[2];
+        for (int x = 0; x < w/2; ++x) {
+            u[x] = uchar(128 + y + i*2);
+            v[x] = uchar(64 + x + i*5);
+        }
+    }
+}
+
+static void fillAudio(qint16 *s, int samples, int channels, qint64 start, int rate)
+{
+    for (int i = 0; i < samples; ++i) {
+        const qreal t = qreal(start + i)/qreal(rate);
+        const qint16 v = qint16(8000.0*qSin(2.0*M_PI*440.0*t) + 4000.0*qSin(2.0*M_PI*1234.5*t));
+        for (int c = 0; c < channels; ++c)
+            s[i*channels + c] = v;
+    }
+}
+
+static bool writePacket(AVFormatContext *oc, AVStream *st, AVPacket *pkt)
+{
+    if (pkt->pts != (int64_t)AV_NOPTS_VALUE)
+        pkt->pts = av_rescale_q(pkt->pts, st->codec->time_base, st->time_base);
+    if (pkt->dts != (int64_t)AV_NOPTS_VALUE)
+        pkt->dts = av_rescale_q(pkt->dts, st->codec->time_base, st->time_base);
+    pkt->stream_index = st->index;
+    const int ret = av_interleaved_write_frame(oc, pkt);
+    av_free_packet(pkt);
+    return ret == 0;
+}
+
+static AVStream* addStream(AVFormatContext *oc, enum CodecID id)
+{
+    AVCodec *codec = avcodec_find_encoder(id);
+    if (!codec) {
+        printf("encoder %d not found\n", id);
+        return 0;
+    }
+    AVStream *st = avformat_new_stream(oc, codec);
+    if (!st)
+        return 0;
+    if (oc->oformat->flags & AVFMT_GLOBALHEADER)
+        st->codec->flags |= CODEC_FLAG_GLOBAL_HEADER;
+    return st;
+}
+
+// mpeg4 video and mp2 audio in matroska. both encoders are always built in FFmpeg and libav
+static bool generateMedia(const QString& path)
+{
+    av_register_all();
+    AVFormatContext *oc = 0;
+    avformat_alloc_output_context2(&oc, 0, "matroska", path.toUtf8().constData());
+    if (!oc)
+        return false;
+    bool ok = false;
+    AVStream *vst = addStream(oc, CODEC_ID_MPEG4);
+    AVStream *ast = addStream(oc, CODEC_ID_MP2);
+    AVFrame *vframe = avcodec_alloc_frame();
+    AVFrame *aframe = avcodec_alloc_frame();
+    AVPicture pic;
+    QByteArray samples;
+    memset(&pic, 0, sizeof(pic));
+    if (vst && ast && vframe && aframe) {
+        AVCodecContext *vc = vst->codec;
+        vc->width = gOpt.width;
+        vc->height = gOpt.height;
+        vc->pix_fmt = QTAV_PIX_FMT_C(YUV420P);
+        vc->time_base.num = 1;
+        vc->time_base.den = gOpt.fps;
+        vc->gop_size = 12;
+        vc->max_b_frames = 0;
+        vc->bit_rate = 4000000;
+        vst->time_base = vc->time_base;
+        AVCodecContext *ac = ast->codec;
+        ac->sample_fmt = AV_SAMPLE_FMT_S16;
+        ac->sample_rate = 44100;
+        ac->channels = 2;
+        ac->channel_layout = AV_CH_LAYOUT_STEREO;
+        ac->bit_rate = 192000;
+        ac->time_base.num = 1;
+        ac->time_base.den = ac->sample_rate;
+        ast->time_base = ac->time_base;
+        ok = avcodec_open2(vc, vc->codec, 0) >= 0
+                && avcodec_open2(ac, ac->codec, 0) >= 0
+                && avpicture_alloc(&pic, vc->pix_fmt, vc->width, vc->height) >= 0
+                && avio_open(&oc->pb, path.toUtf8().constData(), AVIO_FLAG_WRITE) >= 0
+                && avformat_write_header(oc, 0) >= 0;
+    }
+    if (ok) {
+        AVCodecContext *vc = vst->codec;
+        AVCodecContext *ac = ast->codec;
+        const int frames = int(gOpt.seconds*gOpt.fps);
+        const int asamples = ac->frame_size > 0 ? ac->frame_size : 1152;
+        samples.resize(asamples*ac->channels*sizeof(qint16));
+        qint64 apts = 0;
+        for (int i = 0; ok && i < frames;) {
+            AVPacket pkt;
+            av_init_packet(&pkt);
+            pkt.data = 0;
+            pkt.size = 0;
+            int got = 0;
+            // interleave by time
+            if (apts*gOpt.fps < qint64(i)*ac->sample_rate) {
+                avcodec_get_frame_defaults(aframe);
+                aframe->nb_samples = asamples;
+                aframe->pts = apts;
+                fillAudio((qint16*)samples.data(), asamples, ac->channels, apts, ac->sample_rate);
+                avcodec_fill_audio_frame(aframe, ac->channels, ac->sample_fmt, (const uint8_t*)samples.constData(), samples.size(), 0);
+                apts += asamples;
+                ok = avcodec_encode_audio2(ac, &pkt, aframe, &got) >= 0 && (!got || writePacket(oc, ast, &pkt));
+                continue;
+            }
+            avcodec_get_frame_defaults(vframe);
+            for (int p = 0; p < 4; ++p) {
+                vframe->data[p] = pic.data[p];
+                vframe->linesize[p] = pic.linesize[p];
+            }
+            fillPicture(vframe, vc->width, vc->height, i);
+            vframe->pts = i++;
+            ok = avcodec_encode_video2(vc, &pkt, vframe, &got) >= 0 && (!got || writePacket(oc, vst, &pkt));
+        }
+        // delayed packets
+        for (int got = 1; ok && got;) {
+            AVPacket pkt;
+            av_init_packet(&pkt);
+            pkt.data = 0;
+            pkt.size = 0;
+            ok = avcodec_encode_video2(vc, &pkt, 0, &got) >= 0 && (!got || writePacket(oc, vst, &pkt));
+        }
+        ok = av_write_trailer(oc) >= 0 && ok;
+    }
+    if (oc->pb)
+        avio_close(oc->pb);
+    if (vst)
+        avcodec_close(vst->codec);
+    if (ast)
+        avcodec_close(ast->codec);
+    avpicture_free(&pic);
+    av_free(vframe);
+    av_free(aframe);
+    avformat_free_context(oc);
+    return ok;
+}
+
+/************************ micro benchmarks ************************/
+class Producer : public QThread
+{
+public:
+    Producer(PacketQueue *queue, int count) : mQueue(queue), mCount(count) {}
+protected:
+    virtual void run() {
+        Packet pkt;
+        pkt.data = QByteArray(4096, 0);
+        for (int i = 0; i < mCount; ++i) {
+            pkt.pts = i;
+            mQueue->put(pkt);
+        }
+    }
+private:
+    PacketQueue *mQueue;
+    int mCount;
+};
+
+static Result benchQueue()
+{
+    static const int kPackets = 200000;
+    PacketQueue queue;
+    queue.setCapacity(48);
+    queue.setThreshold(32);
+    Producer producer(&queue, kPackets);
+    Measure m;
+    m.start();
+    producer.start();
+    int n = 0;
+    while (n < kPackets) {
+        if (queue.take().isValid())
+            ++n;
+    }
+    producer.wait();
+    m.stop();
+    return m.result(QString(), "packet", n);
+}
+
+static Result benchDemux()
+{
+    AVDemuxer demuxer;
+    if (!demuxer.loadFile(gOpt.media))
+        return Result();
+    Measure m;
+    qint64 packets = 0;
+    m.start();
+    while (true) {
+        if (demuxer.readFrame()) {
+            if (demuxer.packet()->isEnd())
+                break;
+            ++packets;
+        } else if (demuxer.atEnd()) {
+            break;
+        }
+    }
+    m.stop();
+    return m.result(QString(), "packet", packets);
+}
+
+// compressed video packets of the media
+static QList<QByteArray> readVideoPackets(AVDemuxer *demuxer)
+{
+    QList<QByteArray> packets;
+    if (!demuxer->loadFile(gOpt.media))
+        return packets;
+    while (true) {
+        if (demuxer->readFrame()) {
+            if (demuxer->packet()->isEnd())
+                break;
+            if (demuxer->stream() == demuxer->videoStream())
+                packets.append(demuxer->packet()->data);
+        } else if (demuxer->atEnd()) {
+            break;
+        }
+    }
+    return packets;
+}
+
+static VideoDecoder* openDecoder(AVDemuxer *demuxer)
+{
+    VideoDecoder *dec = VideoDecoderFactory::create(VideoDecoderId_FFmpeg);
+    if (!dec)
+        return 0;
+    dec->setCodecContext(demuxer->videoCodecContext());
+    if (!dec->prepare() || !dec->open()) {
+        delete dec;
+        return 0;
+    }
+    return dec;
+}
+
+static Result benchDecode()
+{
+    AVDemuxer demuxer;
+    const QList<QByteArray> packets = readVideoPackets(&demuxer);
+    VideoDecoder *dec = openDecoder(&demuxer);
+    if (!dec)
+        return Result();
+    Measure m;
+    qint64 frames = 0;
+    m.start();
+    foreach (const QByteArray& data, packets) {
+        if (dec->decode(data) && dec->frame().isValid())
+            ++frames;
+    }
+    for (int i = 0; i < 16 && dec->decode(QByteArray()); ++i) {
+        if (dec->frame().isValid())
+            ++frames;
+    }
+    m.stop();
+    dec->close();
+    delete dec;
+    return m.result(QString(), "frame", frames);
+}
+
+static VideoFrame syntheticFrame(int w, int h, VideoFormat::PixelFormat fmt)
+{
+    VideoFrame f(w, h, VideoFormat(fmt));
+    f.allocate();
+    for (int p = 0; p < f.planeCount(); ++p) {
+        uchar *d = f.bits(p);
+        const int lines = p == 0 ? h : f.format().chromaHeight(h);
+        for (int y = 0; y < lines; ++y) {
+            for (int x = 0; x < f.bytesPerLine(p); ++x)
+                d[y*f.bytesPerLine(p) + x] = uchar(x*3 + y + p*50);
+        }
+    }
+    return f;
+}
+
+class ConvertBench {
+public:
+    ConvertBench(VideoFormat::PixelFormat inFormat, const QSize& inSize, VideoFormat::PixelFormat outFormat, const QSize& outSize)
+        : in(inFormat), out(outFormat), in_size(inSize), out_size(outSize)
+    {}
+    Result operator()() const {
+        const VideoFrame frame = syntheticFrame(in_size.width(), in_size.height(), in);
+        ImageConverter *conv = ImageConverterFactory::create(ImageConverterId_FF);
+        if (!conv)
+            return Result();
+        conv->setInFormat(frame.pixelFormatFFmpeg());
+        conv->setInSize(frame.width(), frame.height());
+        conv->setOutFormat(VideoFormat(out).pixelFormatFFmpeg());
+        conv->setOutSize(out_size.width(), out_size.height());
+        const quint8 *planes[4] = { 0, 0, 0, 0 };
+        int strides[4] = { 0, 0, 0, 0 };
+        for (int p = 0; p < frame.planeCount(); ++p) {
+            planes[p] = frame.bits(p);
+            strides[p] = frame.bytesPerLine(p);
+        }
+        // about the same time for each size
+        const int n = qMax(10, int(50000000LL/(in_size.width()*in_size.height())));
+        int frames = 0;
+        Measure m;
+        m.start();
+        for (int i = 0; i < n; ++i) {
+            if (conv->convert(planes, strides))
+                ++frames;
+        }
+        m.stop();
+        delete conv;
+        return m.result(QString(), "frame", frames);
+    }
+private:
+    VideoFormat::PixelFormat in, out;
+    QSize in_size, out_size;
+};
+
+class CloneBench {
+public:
+    CloneBench(const VideoFrame& f) : frame(f) {}
+    Result operator()() const {
+        const int n = qMax(10, int(100000000LL/(frame.width()*frame.height())));
+        Measure m;
+        m.start();
+        for (int i = 0; i < n; ++i) {
+            VideoFrame f(frame.clone());
+        }
+        m.stop();
+        return m.result(QString(), "frame", n);
+    }
+private:
+    VideoFrame frame;
+};
+
+static AudioFormat audioFormat(AudioFormat::SampleFormat sampleFormat, int rate)
+{
+    AudioFormat fmt;
+    fmt.setSampleFormat(sampleFormat);
+    fmt.setSampleRate(rate);
+    fmt.setChannels(2);
+    return fmt;
+}
+
+static QByteArray audioData(const AudioFormat& fmt, int samples)
+{
+    QByteArray data(samples*fmt.bytesPerFrame(), 0);
+    if (fmt.sampleFormat() == AudioFormat::SampleFormat_Signed16) {
+        fillAudio((qint16*)data.data(), samples, fmt.channels(), 0, fmt.sampleRate());
+        return data;
+    }
+    float *d = (float*)data.data();
+    for (int i = 0; i < samples*fmt.channels(); ++i)
+        d[i] = 0.5f*float(qSin(qreal(i)*0.01));
+    return data;
+}
+
+static const int kAudioChunk = 1024; // samples per channel, about a decoded frame
+
+class ResampleBench {
+public:
+    ResampleBench(const AudioFormat& inFormat, const AudioFormat& outFormat) : in(inFormat), out(outFormat) {}
+    Result operator()() const {
+        AudioResampler *r = AudioResamplerFactory::create(AudioResamplerId_FF);
+        if (!r)
+            return Result();
+        r->setInAudioFormat(in);
+        r->setOutAudioFormat(out);
+        r->setInSampesPerChannel(kAudioChunk);
+        if (!r->prepare()) {
+            delete r;
+            return Result();
+        }
+        const QByteArray data = audioData(in, kAudioChunk);
+        const quint8 *planes[1] = { (const quint8*)data.constData() };
+        const int chunks = int(gOpt.seconds*in.sampleRate()/kAudioChunk);
+        Measure m;
+        m.start();
+        int samples = 0;
+        for (int i = 0; i < chunks; ++i) {
+            if (r->convert(planes))
+                samples += kAudioChunk;
+        }
+        m.stop();
+        delete r;
+        return m.result(QString(), "sample", samples);
+    }
+private:
+    AudioFormat in, out;
+};
+
+class VolumeBench {
+public:
+    VolumeBench(const AudioFormat& format) : fmt(format) {}
+    Result operator()() const {
+        AudioFrame frame(audioData(fmt, kAudioChunk), fmt);
+        const int chunks = int(gOpt.seconds*fmt.sampleRate()/kAudioChunk);
+        Measure m;
+        m.start();
+        for (int i = 0; i < chunks; ++i) {
+            AudioDSP::gain(&frame, (i & 1) ? 0.8 : 1.25);
+        }
+        m.stop();
+        return m.result(QString(), "sample", qint64(chunks)*kAudioChunk);
+    }
+private:
+    AudioFormat fmt;
+};
+
+/************************ thumbnails ************************/
+static void countFrame(const FrameExtractor::Result& result, void *opaque)
+{
+    if (result.frame.isValid())
+        static_cast<QAtomicInt*>(opaque)->fetchAndAddRelaxed(1);
+}
+
+// key frame thumbnails. async: the same file extracted by several workers at the same time
+class ExtractBench {
+public:
+    ExtractBench(int files, bool lowres) : nb_files(files), low_res(lowres) {}
+    Result operator()() const {
+        FrameExtractor extractor;
+        extractor.setSize(QSize(160, 90));
+        extractor.setLowResolution(low_res);
+        Measure m;
+        m.start();
+        qint64 frames = 0;
+        if (nb_files <= 1) {
+            const QList<FrameExtractor::Result> results = extractor.extractKeyFrames(gOpt.media, kThumbnails);
+            for (int i = 0; i < results.size(); ++i) {
+                if (results.at(i).frame.isValid())
+                    ++frames;
+            }
+        } else {
+            QStringList files;
+            for (int i = 0; i < nb_files; ++i)
+                files.append(gOpt.media);
+            QAtomicInt count(0);
+            extractor.extractKeyFramesAsync(files, kThumbnails, countFrame, &count);
+            extractor.waitForDone();
+            frames = count.fetchAndAddRelaxed(0);
+        }
+        m.stop();
+        return m.result(QString(), "frame", frames);
+    }
+private:
+    static const int kThumbnails = 10;
+    int nb_files;
+    bool low_res;
+};
+
+/************************ end to end ************************/
+// free run: decoded as fast as possible, the clock does not pace the pipeline
+static void benchPlayer(bool freeRun)
+{
+    const QString name = freeRun ? QString("player/%1x%2@freerun").arg(gOpt.width).arg(gOpt.height)
+                                 : QString("player/%1x%2@%3x").arg(gOpt.width).arg(gOpt.height).arg(gOpt.speed);
+    if (!selected(name))
+        return;
+    VideoRendererNull renderer; // must outlive the player
+    AVPlayer player;
+    AudioOutputNull *ao = new AudioOutputNull(); // deleted by player
+    // free run: audio is still sent to the null output, which does not wait
+    if (freeRun)
+        ao->setRealtimeFactor(0);
+    player.setAudioOutput(ao);
+    player.setRenderer(&renderer);
+    player.setSpeed(gOpt.speed);
+    player.setFreeRun(freeRun);
+    QEventLoop loop;
+    QObject::connect(&player, SIGNAL(stopped()), &loop, SLOT(quit()));
+    QTimer::singleShot(int(gOpt.seconds/gOpt.speed*1000.0) + 10000, &loop, SLOT(quit()));
+    Measure m;
+    m.start();
+    player.play(gOpt.media);
+    loop.exec();
+    m.stop();
+    const bool finished = !player.isPlaying();
+    const Statistics::Pipeline::Snapshot s = player.statistics().video_pipeline.snapshot();
+    const qint64 frames = renderer.receivedFrames();
+    const qint64 dropped = renderer.droppedFrames();
+    const qint64 late = renderer.lateFrames();
+    player.stop();
+    Result r = m.result(name, "frame", frames);
+    r.extra.append(qMakePair(QString("realtime_fps"), r.ns > 0 ? qreal(frames)*1e9/qreal(r.ns)*(freeRun ? 1.0 : gOpt.speed) : 0));
+    r.extra.append(qMakePair(QString("dropped"), qreal(dropped)));
+    r.extra.append(qMakePair(QString("late"), qreal(late)));
+    r.extra.append(qMakePair(QString("decode_p95_us"), qreal(s.stage[Statistics::Pipeline::Decode].p95)));
+    r.extra.append(qMakePair(QString("total_p50_us"), qreal(s.stage[Statistics::Pipeline::Total].p50)));
+    r.extra.append(qMakePair(QString("total_p95_us"), qreal(s.stage[Statistics::Pipeline::Total].p95)));
+    if (!freeRun)
+        r.extra.append(qMakePair(QString("audio_underruns"), qreal(ao->underruns())));
+    if (!finished)
+        printf("%-44s timed out\n", qPrintable(name));
+    report(r);
+}
+
+static bool writeJson(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        printf("can not write %s\n", qPrintable(path));
+        return false;
+    }
+    QByteArray json("{\n");
+    json += QString("  \"media\": {\"width\": %1, \"height\": %2, \"fps\": %3, \"seconds\": %4},\n")
+            .arg(gOpt.width).arg(gOpt.height).arg(gOpt.fps).arg(gOpt.seconds).toUtf8();
+    json += QString("  \"simd\": \"%1\",\n  \"repeat\": %2,\n  \"benchmarks\": [\n")
+            .arg(AudioDSP::simdName()).arg(gOpt.repeat).toUtf8();
+    for (int i = 0; i < gResults.size(); ++i) {
+        const Result& r = gResults.at(i);
+        json += QString("    {\"name\": \"%1\", \"unit\": \"%2\", \"items\": %3, \"ns\": %4, \"allocs\": %5"
+                        ", \"items_per_second\": %6, \"ns_per_item\": %7, \"allocs_per_item\": %8")
+                .arg(r.name).arg(r.unit).arg(r.items).arg(r.ns).arg(r.allocs)
+                .arg(r.ns > 0 ? qreal(r.items)*1e9/qreal(r.ns) : 0, 0, 'f', 2)
+                .arg(r.nsPerItem(), 0, 'f', 2)
+                .arg(r.items > 0 ? qreal(r.allocs)/qreal(r.items) : 0, 0, 'f', 3).toUtf8();
+        for (int j = 0; j < r.extra.size(); ++j)
+            json += QString(", \"%1\": %2").arg(r.extra.at(j).first).arg(r.extra.at(j).second, 0, 'f', 2).toUtf8();
+        json += i + 1 < gResults.size() ? "},\n" : "}\n";
+    }
+    json += "  ]\n}\n";
+    return f.write(json) == json.size();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    const QStringList args = a.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& arg = args.at(i);
+        const QString value = i + 1 < args.size() ? args.at(i + 1) : QString();
+        if (arg == "-o") {
+            gOpt.output = value;
+            ++i;
+        } else if (arg == "-filter") {
+            gOpt.filter = value;
+            ++i;
+        } else if (arg == "-repeat") {
+            gOpt.repeat = qMax(value.toInt(), 1);
+            ++i;
+        } else if (arg == "-seconds") {
+            gOpt.seconds = qMax(value.toDouble(), 1.0);
+            ++i;
+        } else if (arg == "-size") {
+            const QStringList wh = value.split('x');
+            if (wh.size() == 2) {
+                gOpt.width = qMax(wh.at(0).toInt(), 16) & ~1;
+                gOpt.height = qMax(wh.at(1).toInt(), 16) & ~1;
+            }
+            ++i;
+        } else if (arg == "-speed") {
+            gOpt.speed = qMax(value.toDouble(), 0.1);
+            ++i;
+        } else if (arg == "-keep") {
+            gOpt.keep = true;
+        } else {
+            printf("unknown option %s\n", qPrintable(arg));
+            return 1;
+        }
+    }
+    gOpt.media = QDir::temp().filePath(QString("qtav-bench-%1x%2.mkv").arg(gOpt.width).arg(gOpt.height));
+    printf("generating %s: %dx%d %dfps mpeg4 + mp2, %.0fs\n", qPrintable(gOpt.media), gOpt.width, gOpt.height, gOpt.fps, gOpt.seconds);
+    if (!generateMedia(gOpt.media)) {
+        printf("failed to generate media\n");
+        return 1;
+    }
+
+    run("queue/put-take", benchQueue);
+    run("demux/readFrame", benchDemux);
+    run("decode/mpeg4-null", benchDecode);
+    run("extract/keyframes", ExtractBench(1, false));
+    run("extract/keyframes-lowres", ExtractBench(1, true));
+    run("extract/keyframes-lowres-8files", ExtractBench(8, true));
+
+    const QSize sizes[] = { QSize(640, 360), QSize(1280, 720), QSize(1920, 1080) };
+    for (size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i) {
+        const QSize s(sizes[i]);
+        const QString wh = QString("%1x%2").arg(s.width()).arg(s.height());
+        run("convert/yuv420p-rgb32/" + wh, ConvertBench(VideoFormat::Format_YUV420P, s, VideoFormat::Format_RGB32, s));
+        run("convert/nv12-rgb32/" + wh, ConvertBench(VideoFormat::Format_NV12, s, VideoFormat::Format_RGB32, s));
+        run("convert/yuv420p-rgb32-half/" + wh, ConvertBench(VideoFormat::Format_YUV420P, s, VideoFormat::Format_RGB32, s/2));
+        run("convert/yuv420p-scale-half/" + wh, ConvertBench(VideoFormat::Format_YUV420P, s, VideoFormat::Format_YUV420P, s/2));
+        run("clone/yuv420p/" + wh, CloneBench(syntheticFrame(s.width(), s.height(), VideoFormat::Format_YUV420P)));
+    }
+    if (selected("clone/decoded")) {
+        // decoded frames have padded lines
+        AVDemuxer demuxer;
+        const QList<QByteArray> packets = readVideoPackets(&demuxer);
+        VideoDecoder *dec = openDecoder(&demuxer);
+        if (dec) {
+            for (int i = 0; i < packets.size(); ++i) {
+                if (dec->decode(packets.at(i)) && dec->frame().isValid())
+                    break;
+            }
+            const VideoFrame frame(dec->frame());
+            if (frame.isValid())
+                run(QString("clone/decoded/%1x%2").arg(frame.width()).arg(frame.height()), CloneBench(frame));
+            dec->close();
+            delete dec;
+        }
+    }
+
+    const AudioFormat s16_44k = audioFormat(AudioFormat::SampleFormat_Signed16, 44100);
+    const AudioFormat flt_44k = audioFormat(AudioFormat::SampleFormat_Float, 44100);
+    const AudioFormat flt_48k = audioFormat(AudioFormat::SampleFormat_Float, 48000);
+    run("resample/s16-float", ResampleBench(s16_44k, flt_44k));
+    run("resample/s16-44100-float-48000", ResampleBench(s16_44k, flt_48k));
+    run("volume/float", VolumeBench(flt_44k));
+    run("volume/s16", VolumeBench(s16_44k));
+
+    benchPlayer(false);
+    benchPlayer(true);
+
+    if (!gOpt.output.isEmpty() && writeJson(gOpt.output))
+        printf("results: %s\n", qPrintable(gOpt.output));
+    if (!gOpt.keep)
+        QFile::remove(gOpt.media);
+    return 0;
+}
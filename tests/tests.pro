@@ -2,4 +2,6 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     qiodevice \
-    playerthread
+    playerthread \
+    audiostretch \
+    benchmarks